@@ -0,0 +1,65 @@
+/*
+ * 发布端延迟：同步发布与异步发布（SetAsyncPublish）对比
+ * 单个 1 字节主题，扇出 1 / 10 / 100 / 1000 个订阅者，统计每次 PublishMessage() 的 p50 / p99
+ * 用法：bench_async_publish
+ */
+#include "message_interface.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace MQ;
+
+int main()
+{
+    printf("%8s %24s %24s\n", "fan-out", "sync p50 / p99", "async p50 / p99");
+    for(int fan : {1, 10, 100, 1000})
+    {
+        string topic = "fan" + to_string(fan);
+        atomic<long> received(0);
+        vector<MQSparkShPtr> subscribers;
+        for(int i = 0; i < fan; ++i)
+        {
+            auto subscriber = MessageInterface::Create<MessageInterface>();
+            subscriber->SubTopic(topic);
+            subscriber->RegMsgHandleCallback([&received](const Message&) { ++received; });
+            subscribers.push_back(subscriber);
+        }
+
+        double p50[2], p99[2];
+        for(int async = 0; async < 2; ++async)
+        {
+            auto publisher = static_pointer_cast<MessageInterface>(MessageInterface::Create<MessageInterface>());
+            publisher->SetAsyncPublish(async != 0);
+            const int samples = fan >= 100 ? 2000 : 20000;
+            vector<double> latency;
+            latency.reserve(samples);
+            Message msg("x", topic);
+            for(int i = 0; i < samples; ++i)
+            {
+                auto start = chrono::steady_clock::now();
+                publisher->PublishMessage(msg);
+                latency.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+                // 每 64 条停顿一下，让订阅者跟上，测的是发布调用本身而不是队列满后的等待
+                if(i % 64 == 63)
+                {
+                    this_thread::sleep_for(chrono::microseconds(200));
+                }
+            }
+            publisher->FlushPublish();
+            sort(latency.begin(), latency.end());
+            p50[async] = latency[samples / 2];
+            p99[async] = latency[samples * 99 / 100];
+        }
+        printf("%8d %10.0fns / %8.0fns %10.0fns / %8.0fns\n", fan, p50[0], p99[0], p50[1], p99[1]);
+
+        for(auto& subscriber : subscribers)
+        {
+            subscriber->UnsubTopicAll();
+        }
+    }
+    return 0;
+}
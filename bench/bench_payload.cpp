@@ -0,0 +1,68 @@
+/*
+ * 大消息体发布吞吐：std::string 正文与引用计数 Payload 对比
+ * 一个发布者、四个订阅者，每条消息先构造正文再发布，输出每秒消息数
+ * 用法：bench_payload
+ */
+#include "message_interface.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+using namespace MQ;
+
+static double publishRate(const MQSparkShPtr& publisher, int iters, size_t size, bool use_payload)
+{
+    auto start = chrono::steady_clock::now();
+    for(int i = 0; i < iters; ++i)
+    {
+        Message msg;
+        msg.topic_name = "big";
+        if(use_payload)
+        {
+            msg.payload = Payload::FromString(string(size, 'a'));
+        }
+        else
+        {
+            msg.content = string(size, 'a');
+        }
+        publisher->PublishMessage(msg);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return iters / seconds;
+}
+
+int main()
+{
+    atomic<long> received_bytes(0);
+    vector<MQSparkShPtr> subscribers;
+    for(int i = 0; i < 4; ++i)
+    {
+        auto subscriber = MessageInterface::Create<MessageInterface>();
+        subscriber->RegMsgHandleCallback([&received_bytes](const Message& msg) {
+            received_bytes += msg.content.size() + msg.payload.Size();
+        });
+        subscriber->SubTopic("big");
+        subscribers.push_back(subscriber);
+    }
+    auto publisher = MessageInterface::Create<MessageInterface>();
+
+    printf("%8s %12s %12s\n", "size", "string", "payload");
+    for(size_t size : {size_t(64) << 10, size_t(1) << 20, size_t(16) << 20})
+    {
+        // 每种大小发布约 64MB 正文，至少 4 条
+        int iters = static_cast<int>(max<size_t>(4, (size_t(64) << 20) / size));
+        double string_rate = publishRate(publisher, iters, size, false);
+        this_thread::sleep_for(chrono::milliseconds(300));      // 等订阅者消费完，避免互相干扰
+        double payload_rate = publishRate(publisher, iters, size, true);
+        this_thread::sleep_for(chrono::milliseconds(300));
+        printf("%6zuKB %10.0f/s %10.0f/s\n", size >> 10, string_rate, payload_rate);
+    }
+
+    for(auto& subscriber : subscribers)
+    {
+        subscriber->UnsubTopicAll();
+    }
+    return received_bytes.load() > 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ * 编译期策略组合的投递开销：BasicSubscriber/BasicBroker 各策略与 MessageInterface 对比
+ * 1 个订阅者、1 字节消息，输出每条消息的平均耗时
+ * 用法：bench_policy_broker
+ * 注意：“Deliver() only, functor” 一行的循环可能被编译器整体折叠，结果接近 0
+ */
+#include "policy_broker.h"
+#include "message_interface.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+using namespace MQ;
+
+static long sink = 0;
+
+struct Counter
+{
+    long* total;
+    void operator()(const Message& msg) const { *total += msg.content.size(); }
+};
+
+template<typename Body>
+static void bench(const char* name, long iters, Body body)
+{
+    auto start = chrono::steady_clock::now();
+    body(iters);
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iters;
+    printf("%-48s %8.1f ns/msg\n", name, ns);
+}
+
+int main()
+{
+    const long N = 2000000;
+    Message msg("x", "t");
+
+    // 只测回调调用方式本身
+    {
+        auto sub = MakeSubscriber<Policy::InlineDelivery>(Counter{&sink});
+        bench("Deliver() only, functor", N * 5, [&](long n) { for(long i = 0; i < n; ++i) sub->Deliver(msg); });
+        auto erased = MakeSubscriber<Policy::InlineDelivery>(MessageHandle(Counter{&sink}));
+        bench("Deliver() only, std::function", N * 5, [&](long n) { for(long i = 0; i < n; ++i) erased->Deliver(msg); });
+
+        struct Base
+        {
+            virtual ~Base() {}
+            virtual void Handle(const Message& m) = 0;
+        };
+        struct Derived : Base
+        {
+            MessageHandle handle;
+            void Handle(const Message& m) override { handle(m); }
+        };
+        unique_ptr<Derived> derived(new Derived);
+        derived->handle = Counter{&sink};
+        Base* volatile base = derived.get();      // 阻止去虚化
+        bench("virtual + std::function", N * 5, [&](long n) { for(long i = 0; i < n; ++i) base->Handle(msg); });
+    }
+
+    // 经过代理发布
+    {
+        auto sub = MakeSubscriber<Policy::InlineDelivery>(Counter{&sink});
+        BasicBroker<decltype(sub)::element_type, Policy::NullLock> broker;
+        broker.Subscribe("t", *sub);
+        bench("Inline + functor + NullLock", N, [&](long n) { for(long i = 0; i < n; ++i) broker.Publish(msg); });
+    }
+    {
+        auto sub = MakeSubscriber<Policy::InlineDelivery>(MessageHandle(Counter{&sink}));
+        BasicBroker<decltype(sub)::element_type, Policy::NullLock> broker;
+        broker.Subscribe("t", *sub);
+        bench("Inline + std::function + NullLock", N, [&](long n) { for(long i = 0; i < n; ++i) broker.Publish(msg); });
+    }
+    {
+        auto sub = MakeSubscriber<Policy::InlineDelivery>(Counter{&sink});
+        BasicBroker<decltype(sub)::element_type> broker;
+        broker.Subscribe("t", *sub);
+        bench("Inline + functor + mutex", N, [&](long n) { for(long i = 0; i < n; ++i) broker.Publish(msg); });
+    }
+    {
+        auto sub = MakeSubscriber<Policy::PolledDelivery, Policy::RingQueue, Policy::NullLock>(Counter{&sink});
+        BasicBroker<decltype(sub)::element_type, Policy::NullLock> broker;
+        broker.Subscribe("t", *sub);
+        bench("Polled + RingQueue + NullLock (publish+poll)", N, [&](long n) {
+            for(long i = 0; i < n; ++i)
+            {
+                broker.Publish(msg);
+                if((i & 63) == 63)
+                {
+                    sub->Poll();
+                }
+            }
+            sub->Poll();
+        });
+    }
+    {
+        auto sub = MakeSubscriber<Policy::PolledDelivery, Policy::DequeQueue, Policy::MutexLock>(MessageHandle(Counter{&sink}));
+        BasicBroker<decltype(sub)::element_type> broker;
+        broker.Subscribe("t", *sub);
+        bench("Polled + deque + mutex + std::function", N, [&](long n) {
+            for(long i = 0; i < n; ++i)
+            {
+                broker.Publish(msg);
+                if((i & 63) == 63)
+                {
+                    sub->Poll();
+                }
+            }
+            sub->Poll();
+        });
+    }
+
+    // 带分发线程，统计到全部消息处理完为止
+    {
+        atomic<long> received(0);
+        ClassicSubscriber sub([&received](const Message&) { ++received; });
+        ClassicBroker broker;
+        broker.Subscribe("t", sub);
+        bench("ClassicSubscriber (threaded, end-to-end)", N / 4, [&](long n) {
+            for(long i = 0; i < n; ++i)
+            {
+                broker.Publish(msg);
+            }
+            while(received < n)
+            {
+                this_thread::yield();
+            }
+        });
+        broker.UnsubscribeAll(sub);
+    }
+    {
+        atomic<long> received(0);
+        auto sub = MessageInterface::Create<MessageInterface>();
+        sub->SubTopic("t");
+        sub->RegMsgHandleCallback([&received](const Message&) { ++received; });
+        bench("MessageInterface (runtime broker, end-to-end)", N / 4, [&](long n) {
+            for(long i = 0; i < n; ++i)
+            {
+                sub->PublishMessage(msg);
+            }
+            while(received < n)
+            {
+                this_thread::yield();
+            }
+        });
+        sub->UnsubTopicAll();
+    }
+    return sink > 0 ? 0 : 1;
+}
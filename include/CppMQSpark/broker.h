@@ -0,0 +1,78 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_BROKER_H
+#define C__MQSPARK_BROKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+using namespace std;
+
+namespace MQ
+{
+    class Broker;
+    using BrokerPtr = shared_ptr<Broker>;
+
+    /**
+     * @brief 消息代理实例句柄
+     * @note 每个代理拥有独立的主题注册表、锁和定时器，不同代理之间的消息互不可见。
+     * 分片模式下主题按名称哈希到 N 个分片，每个分片有独立的注册表和锁，互不相关的主题可以并行发布
+     * @code{.cpp}
+     * BrokerPtr broker = Broker::Create(4);     // 4 个分片的独立代理
+     * MQSparkShPtr mqs = MessageInterface::Create<MessageInterface>(broker);
+     * @endcode
+     * @warning 使用该代理的 MessageInterface 会持有代理引用，代理在最后一个使用者释放后销毁
+     */
+    class Broker
+    {
+    public:
+        /**
+         * @brief 创建独立的代理实例
+         * @param shard_count 分片数量，0 按 1 处理
+         */
+        static BrokerPtr Create(size_t shard_count = 1);
+
+        static BrokerPtr Default();             ///< 进程默认代理，未指定代理的 MessageInterface 绑定到它
+        size_t ShardCount() const;
+
+        /**
+         * @brief 开启幂等发布：丢弃 (headers.producer_id, headers.producer_seq) 已发布过的消息
+         * @param producer_slots 每个分片同时跟踪的生产者数量，0 表示关闭
+         * @note 每个生产者记录最近 64 个序号，判断为 O(1)，内存固定；producer_id 为 0 的消息不参与去重。
+         * 同步发布在进入分片时判断；异步发布在分发线程取出时判断，同一生产者的顺序不变；
+         * 定时消息在 PublishAt()/PublishAfter() 提交时判断，到期投递时不再判断，
+         * 重复时返回 0 且不会投递。已提交后取消的定时消息，其序号仍视为已发布
+         * @code{.cpp}
+         * broker->EnableDedup(4096);
+         * msg.headers.producer_id = my_id;
+         * msg.headers.producer_seq = ++my_seq;     // 重试时保持不变
+         * @endcode
+         */
+        void EnableDedup(size_t producer_slots = 4096);
+        uint64_t DuplicateCount() const;        ///< 已丢弃的重复消息数
+
+        ~Broker();
+        Broker(const Broker&) = delete;
+        Broker& operator=(const Broker&) = delete;
+
+    private:
+        friend class MessageInterface;
+        struct BrokerImpl;
+        explicit Broker(unique_ptr<BrokerImpl> impl);
+        unique_ptr<BrokerImpl> m_impl;
+    };
+}
+
+#endif//C__MQSPARK_BROKER_H
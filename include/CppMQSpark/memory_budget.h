@@ -0,0 +1,152 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_MEMORY_BUDGET_H
+#define C__MQSPARK_MEMORY_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+using namespace std;
+
+namespace MQ
+{
+    struct CppMessage;
+    class MQSparkAbstract;
+
+    /**
+     * @brief 超出内存预算时的处理方式
+     */
+    enum class OverflowPolicy
+    {
+        Backpressure,           ///< 发布线程等待订阅者腾出空间，超过最长等待时间仍不足则丢弃该条消息
+        ShedLowestPriority,     ///< 从优先级不高于接收者的订阅者中，按优先级从低到高丢弃最早入队的消息
+    };
+
+    /**
+     * @brief 单个订阅者的队列内存占用
+     */
+    struct SubscriberMemory
+    {
+        const MQSparkAbstract* subscriber = nullptr;
+        int priority = 0;
+        size_t queued_bytes = 0;
+        size_t queued_messages = 0;
+        uint64_t shed_count = 0;        ///< 因内存预算被丢弃的消息数
+    };
+
+    /**
+     * @brief 进程级订阅者队列内存预算与统计
+     * @note 所有代理实例的订阅者共用同一份预算。消息大小按 MessageBytes() 估算，
+     * 共享的 Payload 在每个持有它的队列中都计入一次，因此总量是上界。
+     * 未设置上限时只做统计：入队/出队各多一次原子加减，并在队列锁内按主题名查找一次统计表
+     * @code{.cpp}
+     * MemoryBudget& budget = MemoryBudget::GetInstance();
+     * budget.SetLimit(256 << 20);
+     * budget.SetPolicy(OverflowPolicy::ShedLowestPriority);
+     * audit->SetPriority(-1);                      // 内存紧张时优先丢弃
+     * size_t orders = budget.TopicQueuedBytes("orders");
+     * @endcode
+     */
+    class MemoryBudget
+    {
+    public:
+        static MemoryBudget& GetInstance()
+        {
+            static MemoryBudget instance;
+            return instance;
+        }
+
+        /**
+         * @brief 设置进程级预算
+         * @param bytes 全部订阅者队列的字节上限，0 表示不限制
+         */
+        void SetLimit(size_t bytes);
+        size_t GetLimit() const;
+
+        /**
+         * @brief 设置超出预算时的处理方式
+         * @param max_block Backpressure 模式下发布线程的最长等待时间
+         * @note Backpressure 在取分片锁之前为一次发布的全部订阅者统一等待，分片锁内只做不等待的申请，
+         * 仍不足的订阅者丢弃该条消息。等待必须有上限，否则在回调中向自身发布会一直等待
+         */
+        void SetPolicy(OverflowPolicy policy, chrono::milliseconds max_block = chrono::milliseconds(100));
+        OverflowPolicy GetPolicy() const;
+
+        size_t QueuedBytes() const;                             ///< 全部订阅者队列中的字节数
+        uint64_t ShedCount() const;                             ///< 因预算被丢弃的消息总数
+        size_t TopicQueuedBytes(const string& topic_name);      ///< 指定主题在各订阅者队列中的字节数
+        unordered_map<string, size_t> TopicUsage();             ///< 各主题占用，不含已清空的主题
+        vector<SubscriberMemory> SubscriberUsage();             ///< 各订阅者占用
+
+        static size_t MessageBytes(const CppMessage& msg);      ///< 估算一条排队消息占用的字节数
+
+        /**
+         * @brief 一次发布的扇出预留，供代理发布路径在取分片锁之前使用
+         * @note 预留额度记在当前线程上，随后本线程内的入队优先从中扣除；析构时归还未用完的部分
+         */
+        class FanoutReservation
+        {
+        public:
+            FanoutReservation() : m_reserved(0) {}
+            ~FanoutReservation();
+            FanoutReservation(const FanoutReservation&) = delete;
+            FanoutReservation& operator=(const FanoutReservation&) = delete;
+
+            static bool Needed();               ///< 仅 Backpressure 且设置了上限时需要预留
+            void Reserve(size_t bytes);         ///< 可能等待，调用时不得持有分片锁和队列锁
+
+        private:
+            size_t m_reserved;
+        };
+
+    private:
+        friend class MQSparkAbstract;
+
+        MemoryBudget();
+        MemoryBudget(const MemoryBudget&) = delete;
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+        void Register(MQSparkAbstract* subscriber);
+        void Unregister(MQSparkAbstract* subscriber);
+        bool Acquire(MQSparkAbstract* subscriber, size_t bytes);    ///< 入队前申请，不等待，返回 false 表示丢弃该消息
+        void Release(size_t bytes);                                 ///< 出队后归还
+
+        bool tryReserve(size_t bytes, size_t limit);
+        bool waitForSpace(size_t bytes, size_t limit);
+        bool shedFor(MQSparkAbstract* subscriber, size_t bytes, size_t limit);
+
+        atomic<size_t> m_total;
+        atomic<size_t> m_limit;
+        atomic<uint64_t> m_shed_count;
+        atomic<OverflowPolicy> m_policy;
+        atomic<int64_t> m_max_block_ms;
+
+        mutex m_registry_mtx;           ///< 加锁顺序：m_registry_mtx -> 订阅者队列锁
+        unordered_set<MQSparkAbstract*> m_subscribers;
+
+        mutex m_wait_mtx;
+        condition_variable m_wait_cv;
+        atomic<int> m_waiters;
+    };
+}
+
+#endif//C__MQSPARK_MEMORY_BUDGET_H
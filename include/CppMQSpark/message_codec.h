@@ -0,0 +1,84 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_MESSAGE_CODEC_H
+#define C__MQSPARK_MESSAGE_CODEC_H
+
+#include "mqspark_abstract.h"
+
+namespace MQ
+{
+    /**
+     * @brief 消息的紧凑二进制编码
+     * @note 格式（长度均为 LEB128 varint）：
+     * [版本][发布时间][序列号][生产者标识][生产者序号][ttl_ms][主题][头部块][content][payload]，
+     * 其中字节串为 [varint 长度][数据]，头部块与 MessageHeaders 内存布局一致
+     */
+    class MessageCodec
+    {
+    public:
+        static const uint8_t kVersion = 1;
+
+        static void Encode(const Message& msg, string& out);    ///< 追加到 out 末尾
+        static string Encode(const Message& msg);
+    };
+
+    /**
+     * @brief 在编码数据上直接读取消息字段，不复制、不分配内存
+     * @note 视图不持有数据，原始缓冲区必须在视图使用期间保持有效
+     * @code{.cpp}
+     * MessageView view(buf.data(), buf.size());
+     * if (view.IsValid() && view.Topic() == ByteView("orders")) {
+     *     ByteView trace;
+     *     view.Headers().Find("trace-id", trace);
+     * }
+     * @endcode
+     */
+    class MessageView
+    {
+    public:
+        MessageView(const char* data, size_t size);
+        explicit MessageView(const string& encoded) : MessageView(encoded.data(), encoded.size()) {}
+
+        bool IsValid() const { return m_valid; }
+        size_t EncodedSize() const { return m_encoded_size; }   ///< 本条消息占用的字节数，便于顺序读取多条
+
+        int64_t PublishTimeUs() const { return m_publish_time_us; }
+        uint64_t Sequence() const { return m_sequence; }
+        uint64_t ProducerId() const { return m_producer_id; }
+        uint64_t ProducerSeq() const { return m_producer_seq; }
+        uint32_t TtlMs() const { return m_ttl_ms; }
+        ByteView Topic() const { return m_topic; }
+        HeaderBlockView Headers() const { return HeaderBlockView(m_headers.data, m_headers.size); }
+        ByteView Content() const { return m_content; }
+        ByteView PayloadBytes() const { return m_payload; }
+
+        Message ToMessage() const;      ///< 完整解码，payload 会复制一份
+
+    private:
+        bool m_valid;
+        size_t m_encoded_size;
+        int64_t m_publish_time_us;
+        uint64_t m_sequence;
+        uint64_t m_producer_id;
+        uint64_t m_producer_seq;
+        uint32_t m_ttl_ms;
+        ByteView m_topic;
+        ByteView m_headers;
+        ByteView m_content;
+        ByteView m_payload;
+    };
+}
+
+#endif//C__MQSPARK_MESSAGE_CODEC_H
@@ -0,0 +1,131 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_MESSAGE_HEADERS_H
+#define C__MQSPARK_MESSAGE_HEADERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+using namespace std;
+
+namespace MQ
+{
+    /**
+     * @brief 只读字节视图，不持有数据
+     */
+    struct ByteView
+    {
+        const char* data = nullptr;
+        size_t size = 0;
+
+        ByteView() = default;
+        ByteView(const char* d, size_t n) : data(d), size(n) {}
+        ByteView(const char* s) : data(s), size(s == nullptr ? 0 : strlen(s)) {}
+        ByteView(const string& s) : data(s.data()), size(s.size()) {}
+
+        bool Empty() const { return size == 0; }
+        string ToString() const { return string(data == nullptr ? "" : data, size); }
+        bool operator==(const ByteView& other) const
+        {
+            return size == other.size && (size == 0 || memcmp(data, other.data, size) == 0);
+        }
+        bool operator!=(const ByteView& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief 头部键值块的只读视图
+     * @note 块格式：[varint 路由键长度][路由键] 之后重复 [varint 名称长度][名称][varint 值长度][值]，
+     * 直接在原始字节上查找，不做反序列化
+     */
+    class HeaderBlockView
+    {
+    public:
+        using Visitor = function<void(ByteView name, ByteView value)>;
+
+        HeaderBlockView() = default;
+        HeaderBlockView(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+        ByteView Key() const;
+        bool Find(ByteView name, ByteView& value) const;    ///< 返回第一个同名条目
+        void ForEach(const Visitor& visitor) const;
+        size_t Count() const;
+        bool IsValid() const;                               ///< 校验块格式是否完整
+        ByteView Bytes() const { return ByteView(m_data, m_size); }     ///< 编码后的原始字节
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    /**
+     * @brief 消息头部
+     * @note 发布时间与序列号由代理在发布时写入；路由键与用户键值对编码在同一块连续内存中，
+     * 总长度不超过 kInlineSize 时不分配堆内存
+     * @code{.cpp}
+     * Message msg("payload", "orders");
+     * msg.headers.SetKey("user-42");
+     * msg.headers.Add("trace-id", "a1b2c3");
+     * // 回调中
+     * ByteView trace;
+     * if (msg.headers.Find("trace-id", trace)) { ... }
+     * @endcode
+     */
+    class MessageHeaders
+    {
+    public:
+        static const size_t kInlineSize = 48;
+
+        MessageHeaders();
+        MessageHeaders(const MessageHeaders& other);
+        MessageHeaders(MessageHeaders&& other) noexcept;
+        MessageHeaders& operator=(const MessageHeaders& other);
+        MessageHeaders& operator=(MessageHeaders&& other) noexcept;
+        ~MessageHeaders() = default;
+
+        int64_t publish_time_us = 0;    ///< 发布时间（system_clock 微秒），由代理写入
+        uint64_t sequence = 0;          ///< 主题内从 1 开始连续递增的序列号，由代理写入，可用 SequenceTracker 检测丢失
+        uint64_t producer_id = 0;       ///< 生产者标识，非 0 且代理开启去重时按 (producer_id, producer_seq) 去重
+        uint64_t producer_seq = 0;      ///< 生产者自增序号，重试同一条消息时保持不变
+
+        void SetKey(ByteView key);                          ///< 设置路由键
+        ByteView Key() const { return Block().Key(); }
+        void Add(ByteView name, ByteView value);            ///< 追加键值对，允许重名
+        bool Find(ByteView name, ByteView& value) const { return Block().Find(name, value); }
+        void ForEach(const HeaderBlockView::Visitor& visitor) const { Block().ForEach(visitor); }
+        size_t Count() const { return Block().Count(); }
+        void Clear();
+
+        HeaderBlockView Block() const { return HeaderBlockView(data(), m_size); }
+        bool AssignBlock(ByteView block);                   ///< 以编码好的块整体替换，用于解码；格式不完整时清空并返回 false
+        bool IsInline() const { return !m_heap; }
+
+    private:
+        const char* data() const { return m_heap ? m_heap.get() : m_inline; }
+        char* data() { return m_heap ? m_heap.get() : m_inline; }
+        void reserve(size_t capacity);
+        void append(const char* bytes, size_t n);
+        void appendVarint(uint64_t value);
+
+        char m_inline[kInlineSize];
+        unique_ptr<char[]> m_heap;
+        size_t m_size;
+        size_t m_capacity;
+    };
+}
+
+#endif//C__MQSPARK_MESSAGE_HEADERS_H
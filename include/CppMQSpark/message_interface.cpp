@@ -2,22 +2,62 @@
 #include <stdexcept>
 #include "cppmqspark.h"
 #include <iostream>
+#include <thread>
 namespace MQ
 {
 
     struct MessageInterface::MQImplHide
     {
         SmartSpark spark_ptr;
+        shared_ptr<PublishRing> publish_ring;   ///< 异步发布缓冲区，首次开启异步发布时分配
+        bool async_publish = false;
+        
+        void CloseRing()
+        {
+            if(publish_ring)
+            {
+                publish_ring->Close();
+            }
+        }
     };
-    MessageInterface::~MessageInterface() = default;
+    MessageInterface::~MessageInterface()
+    {
+        // 未经 Create() 创建的实例不会经过 Retire()，需要同步摘除，避免主题上留下悬空指针
+        if(!m_retired && MQImpl_)
+        {
+            MQImpl_->CloseRing();
+            MQImpl_->spark_ptr->DelClientNow(this);
+        }
+    }
+    
+    void MessageInterface::Retire()
+    {
+        StopDispatch(true);
+        m_retired = true;
+        // 缓冲区中剩余的消息仍由分发线程发布，之后缓冲区随之释放
+        MQImpl_->CloseRing();
+        MQImpl_->publish_ring.reset();
+        // 失效后不再持有代理，避免挂在冷门主题上的失效订阅者让独立代理及其线程一直存活；
+        // 代理若因此析构，会接管仍未回收的失效订阅者。RetireClient() 之后本对象随时可能被回收，不能再访问成员
+        SmartSpark spark = std::move(MQImpl_->spark_ptr);
+        spark->RetireClient(this);
+    }
     MessageInterface::MessageInterface()
+        : MessageInterface(Broker::Default())
+    {}
+    
+    MessageInterface::MessageInterface(const BrokerPtr& broker)
     {
+        if(broker == nullptr)
+        {
+            throw invalid_argument("代理实例不能为空");
+        }
 #if USING_CPP14
         MQImpl_ = make_unique<MQImplHide>();
 #elif USING_CPP11 == 201103L
         MQImpl_.reset(new MQImplHide);
 #endif
-        MQImpl_->spark_ptr = CppMQSpark::GetSharedInstance();
+        MQImpl_->spark_ptr = broker->m_impl->spark_ptr;
     }
 
     void MessageInterface::SubTopic(const string& topic_name)
@@ -39,7 +79,7 @@ namespace MQ
         {
             throw invalid_argument("消息处理回调函数只能设置一次");
         }
-        m_handle_ = handle;
+        SetHandle(std::move(handle));
     }
     void MessageInterface::UnsubTopic(const string &topic_name)
     {
@@ -57,36 +97,100 @@ namespace MQ
 
     void MessageInterface::PublishMessage(const Message &msg)
     {
-        if(msg.topic_name.empty() || msg.content.empty())
+        if(msg.topic_name.empty() || (msg.content.empty() && msg.payload.Empty()))
         {
             throw invalid_argument("主题名称或者消息内容为空");
         }
+        if(MQImpl_->async_publish)
+        {
+            MQImpl_->publish_ring->Push(Message(msg));
+            return;
+        }
         MQImpl_->spark_ptr->PublishMsg(msg);
     }
     
     void MessageInterface::PublishMessage(Message&& msg)
     {
-        if(msg.topic_name.empty() || msg.content.empty())
+        if(msg.topic_name.empty() || (msg.content.empty() && msg.payload.Empty()))
         {
             throw invalid_argument("主题名称或者消息内容为空");
         }
+        if(MQImpl_->async_publish)
+        {
+            MQImpl_->publish_ring->Push(std::move(msg));
+            return;
+        }
         MQImpl_->spark_ptr->PublishMsg(std::move(msg));
     }
     
-    void MessageInterface::HandleMessage(const Message &msg)
+    void MessageInterface::SetAsyncPublish(bool enable)
     {
-        if(m_handle_ != nullptr)
+        if(enable && !MQImpl_->publish_ring)
         {
-            m_handle_(msg);
+            MQImpl_->publish_ring = MQImpl_->spark_ptr->RegisterAsyncProducer();
         }
+        if(!enable)
+        {
+            // 切回同步前发布完缓冲区，保证先后顺序
+            FlushPublish();
+        }
+        MQImpl_->async_publish = enable;
     }
     
-    void MessageInterface::HandleMessage(Message&& msg)
+    bool MessageInterface::IsAsyncPublish() const
     {
-        if(m_handle_ != nullptr)
+        return MQImpl_->async_publish;
+    }
+    
+    void MessageInterface::FlushPublish()
+    {
+        if(!MQImpl_->publish_ring)
+        {
+            return;
+        }
+        while(!MQImpl_->publish_ring->Drained())
         {
-            m_handle_(msg);
+            this_thread::yield();
         }
     }
+    
+    uint64_t MessageInterface::PublishAt(const Message &msg, chrono::system_clock::time_point when)
+    {
+        return PublishAfter(msg, chrono::duration_cast<chrono::milliseconds>(when - chrono::system_clock::now()));
+    }
+    
+    uint64_t MessageInterface::PublishAfter(const Message &msg, chrono::milliseconds delay)
+    {
+        if(msg.topic_name.empty() || (msg.content.empty() && msg.payload.Empty()))
+        {
+            throw invalid_argument("主题名称或者消息内容为空");
+        }
+        return MQImpl_->spark_ptr->SchedulePublish(msg, chrono::steady_clock::now() + delay);
+    }
+    
+    bool MessageInterface::CancelPublish(uint64_t timer_id)
+    {
+        return MQImpl_->spark_ptr->CancelScheduled(timer_id);
+    }
+    
+    void MessageInterface::SetTopicTTL(const string &topic_name, uint32_t ttl_ms)
+    {
+        if(topic_name.empty())
+        {
+            throw invalid_argument("主题名称不能为空");
+        }
+        MQImpl_->spark_ptr->SetTopicTTL(topic_name, ttl_ms);
+    }
+    
+    void MessageInterface::HandleMessage(const Message &msg)
+    {
+        // 投递到分发线程队列，由分发线程调用回调，不占用发布者线程
+        MQSparkAbstract::HandleMessage(msg);
+    }
+    
+    void MessageInterface::HandleMessage(Message&& msg)
+    {
+        MQSparkAbstract::HandleMessage(std::move(msg));
+    }
 
 }// namespace MQ
@@ -16,8 +16,11 @@
 #ifndef C__MQSPARK_MESSAGE_INTERFACE_H
 #define C__MQSPARK_MESSAGE_INTERFACE_H
 #include "mqspark_abstract.h"
+#include "broker.h"
 #include <memory>
 #include <list>
+#include <chrono>
+#include <cstdint>
 namespace MQ
 {
 
@@ -41,7 +44,7 @@ namespace MQ
      * Message msg("Hello", "test");
      * mqs->PublishMessage(msg);
      *
-     * // 4. 资源释放（可选）
+     * // 4. 资源释放（可选，释放最后一个引用时自动取消订阅）
      * mqs->UnsubTopicAll();
      * @endcode
      * @throw std::invalid_argument 在以下情况会抛出该异常：
@@ -54,7 +57,14 @@ namespace MQ
     class MessageInterface : public MQSparkAbstract
     {
     public:
-        MessageInterface();
+        MessageInterface();                                 ///< 绑定到进程默认代理
+        
+        /**
+         * @brief 绑定到指定代理
+         * @param broker Broker::Create() 创建的代理
+         * @throw std::invalid_argument 代理为空
+         */
+        explicit MessageInterface(const BrokerPtr& broker);
         ~MessageInterface() override;
         
         // 移动语义支持
@@ -93,7 +103,7 @@ namespace MQ
 
         /**
          * @brief 取消所有订阅
-         * @note 析构前手动调用,否则注册的回调函数会一直触发
+         * @note 可选调用；最后一个引用释放后订阅会自动失效，回调不再触发
          */
         void UnsubTopicAll() override;
 
@@ -115,12 +125,65 @@ namespace MQ
          * @param msg 消息对象（必须包含有效topic）
          */
         void PublishMessage(Message&& msg);
+        
+        /**
+         * @brief 在指定时间点发布消息
+         * @param msg 消息对象（必须包含有效topic）
+         * @param when 投递时间，已过去的时间点会尽快投递
+         * @return 定时器 id，可用于 CancelPublish()；代理开启去重且判定为重复时返回 0
+         * @note 由代理端统一的分层时间轮管理，不占用调用者线程
+         */
+        uint64_t PublishAt(const Message& msg, chrono::system_clock::time_point when);
+        
+        /**
+         * @brief 延时发布消息
+         * @param msg 消息对象（必须包含有效topic）
+         * @param delay 延时时长，精度为 1ms
+         * @return 定时器 id，可用于 CancelPublish()；代理开启去重且判定为重复时返回 0
+         */
+        uint64_t PublishAfter(const Message& msg, chrono::milliseconds delay);
+        
+        /**
+         * @brief 取消尚未投递的延时/定时消息
+         * @param timer_id PublishAt()/PublishAfter() 返回的 id
+         * @return 已投递或 id 不存在时返回 false
+         */
+        bool CancelPublish(uint64_t timer_id);
+        
+        /**
+         * @brief 设置主题默认的消息存活时间
+         * @param topic_name 主题名称，主题尚未创建时同样生效
+         * @param ttl_ms 存活时间（毫秒），0 表示取消；消息自身的 ttl_ms 优先
+         * @note 过期消息在订阅者出队时直接丢弃，不会触发回调，可通过 GetExpiredCount() 查询
+         * @throw std::invalid_argument 空主题会抛出错误
+         */
+        void SetTopicTTL(const string& topic_name, uint32_t ttl_ms);
+        
+        /**
+         * @brief 开启/关闭异步发布
+         * @param enable true 时 PublishMessage() 只做一次无锁入队即返回，路由和扇出由代理的分发线程完成
+         * @note 同一实例发布的消息保持先后顺序；缓冲区满时 PublishMessage() 等待分发线程腾出空间。
+         * 关闭时先等待已入队的消息发布完毕。应在开始发布前设置，不要与 PublishMessage() 并发调用
+         * @code{.cpp}
+         * mqs->SetAsyncPublish(true);
+         * mqs->PublishMessage(Message("tick", "market"));   // 立即返回
+         * mqs->FlushPublish();                              // 需要确认已发布时调用
+         * @endcode
+         */
+        void SetAsyncPublish(bool enable);
+        bool IsAsyncPublish() const;
+        
+        /**
+         * @brief 阻塞直到已异步发布的消息全部交给订阅者
+         * @note 同步模式下直接返回
+         */
+        void FlushPublish();
 
     protected:
         /**
          * @brief 消息处理虚函数（供派生类覆盖）
          * @param msg 接收到的消息
-         * @note 基类默认实现会将消息传递给注册的回调函数
+         * @note 默认实现将消息投递到分发线程队列，由分发线程调用注册的回调函数
          */
         void HandleMessage(const Message& msg) override;
         
@@ -130,9 +193,15 @@ namespace MQ
          */
         virtual void HandleMessage(Message&& msg);
         
+        /**
+         * @brief 最后一个引用释放后停止分发，交给代理在发布路径上摘除并延迟回收
+         */
+        void Retire() override;
+        
     private:
         struct MQImplHide;  ///< 前置声明 PIMPL模式隐藏实现细节
         unique_ptr<MQImplHide> MQImpl_;   ////< 核心实现指针
+        bool m_retired = false;           ///< 已交给代理回收
     };
 
 }// namespace MQ
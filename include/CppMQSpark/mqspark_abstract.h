@@ -15,6 +15,9 @@
 #ifndef C__MQSPARK_MQSPARK_ABSTRACT_H
 #define C__MQSPARK_MQSPARK_ABSTRACT_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,6 +26,11 @@
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <unordered_map>
+#include <vector>
+#include "payload.h"
+#include "message_headers.h"
+#include "memory_budget.h"
 using namespace std;
 
 namespace MQ
@@ -35,6 +43,11 @@ namespace MQ
             content = std::move(cont);
             topic_name = std::move(topic);
         }
+        CppMessage(string cont, string topic, uint32_t ttl)
+            : CppMessage(std::move(cont), std::move(topic))
+        {
+            ttl_ms = ttl;
+        }
         CppMessage(const CppMessage&) = default;
         CppMessage(CppMessage&&) = default;
         CppMessage& operator=(const CppMessage&) = default;
@@ -42,6 +55,15 @@ namespace MQ
         
         string content;
         string topic_name;
+        Payload payload;                            ///< 大块数据使用的零拷贝负载，可与 content 同时使用
+        MessageHeaders headers;                     ///< 发布时间、序列号、路由键及用户键值对
+        uint32_t ttl_ms = 0;                        ///< 消息存活时间（毫秒），0 表示使用主题默认值
+        chrono::steady_clock::time_point expire_at; ///< 发布时由代理写入的过期时间，默认值表示永不过期
+        
+        bool IsExpired(chrono::steady_clock::time_point now) const
+        {
+            return expire_at != chrono::steady_clock::time_point() && now >= expire_at;
+        }
     } Message;
 
     using MessageHandle = std::function<void(const Message &msg)>;
@@ -53,7 +75,8 @@ namespace MQ
         static std::shared_ptr<T> Create(Args&&... args)
         {
             static_assert(std::is_base_of<MQSparkAbstract, T>::value, "T 必须继承自 MQSparkAbstract");
-            auto ptr = std::make_shared<T>(std::forward<Args>(args)...);
+            // 最后一个引用释放时交给 Retire()，由派生类决定立即析构还是延迟回收
+            std::shared_ptr<T> ptr(new T(std::forward<Args>(args)...), [](T* p){ static_cast<MQSparkAbstract*>(p)->Retire(); });
             return ptr;
         }
         
@@ -69,18 +92,109 @@ namespace MQ
         // 处理消息的重载版本
         virtual void HandleMessage(const Message &msg);                 ///< 处理消息（拷贝版本）
         virtual void HandleMessage(Message&& msg);                      ///< 处理消息（移动版本）
+        
+        /**
+         * @brief 将消息分发线程绑定到指定 CPU 集合
+         * @param cpus CPU 编号列表
+         * @return 绑定成功返回 true，cpus 为空或平台不支持（非 Linux）时返回 false
+         * @note 只固定回调的执行位置；队列节点和消息体由发布线程分配，内存仍按首次访问落在发布线程所在节点
+         */
+        bool SetDispatchCpus(const vector<int>& cpus);
+        
+        /**
+         * @brief 将消息分发线程绑定到指定 NUMA 节点的全部 CPU
+         * @param node NUMA 节点编号
+         * @return 单节点机器上为空操作并返回 false
+         */
+        bool SetDispatchNumaNode(int node);
+        
+        vector<int> GetDispatchCpus() const;                            ///< 获取分发线程绑定的 CPU（未绑定为空）
+        
+        /**
+         * @brief 将调用线程绑定到指定 CPU 集合
+         * @note 配合 GetDispatchCpus() 使用，可以让发布线程与其最热的订阅者处于同一节点
+         */
+        static bool BindCurrentThread(const vector<int>& cpus);
+        
+        bool IsAlive() const { return m_alive.load(memory_order_acquire); }    ///< 所有者释放后即失效，不再接收消息
+        
+        /**
+         * @brief 回收已停止分发的实例，供代理回收失效订阅者使用
+         * @note 若分发线程仍在执行回调（在自身回调中释放了最后一个引用），改由分发线程在回调返回、
+         * 退出循环后 delete this；调用后不得再访问该实例
+         */
+        void DeleteWhenIdle();
+        
+        uint64_t GetExpiredCount() const;                               ///< 已过期丢弃的消息数
+        
+        /**
+         * @brief 设置队列主动清理过期消息的阈值
+         * @param threshold 入队后队列长度超过该值时，扫描整个队列移除已过期消息；0 表示不主动清理
+         * @note 队列中 TTL 不同的消息可能交错，只清理队首会被长 TTL 的消息挡住，因此超过阈值时整队压缩。
+         * 压缩后需积压到剩余长度的两倍才再次扫描，均摊到每次入队为常数开销。
+         * 出队时只检查队首，过期消息在到达队首时跳过
+         */
+        void SetExpireTrimThreshold(size_t threshold);
+        
+        /**
+         * @brief 设置内存预算下的优先级
+         * @param priority 数值越小越先被丢弃，默认 0
+         * @see MemoryBudget
+         */
+        void SetPriority(int priority);
+        int GetPriority() const;
+        size_t GetQueuedBytes() const;                                  ///< 队列中消息占用的字节数（估算）
+        uint64_t GetShedCount() const;                                  ///< 因内存预算被丢弃的消息数
 
     protected:
+        /**
+         * @brief 最后一个外部引用释放时调用（仅限 Create() 创建的实例）
+         * @note 默认实现停止分发线程后通过 DeleteWhenIdle() 回收；派生类可覆盖为延迟回收，
+         * 但必须最终经 DeleteWhenIdle() 释放。允许在自身的消息回调中释放最后一个引用
+         */
+        virtual void Retire();
+        
+        /**
+         * @brief 标记失效并停止分发线程
+         * @param discard_pending 为 true 时丢弃队列中尚未处理的消息
+         */
+        void StopDispatch(bool discard_pending);
+        
+        /**
+         * @brief 在队列锁内设置回调，分发线程读到非空回调后不会再被修改
+         */
+        void SetHandle(MessageHandle handle);
+        
         MessageHandle m_handle_;
         
     private:
+        friend class MemoryBudget;
+        
         void messageProcessLoop();
+        void enqueue(Message&& msg);
+        void enqueueLocked(Message&& msg, size_t bytes);
+        void popFrontLocked(Message* out);      ///< 出队并归还预算，out 为空时直接丢弃
+        void clearLocked();
+        bool shedOldest();                      ///< 供 MemoryBudget 丢弃最早的一条消息
+        void trimExpired(chrono::steady_clock::time_point now);        ///< 清理队首连续过期的消息
+        void compactExpired(chrono::steady_clock::time_point now);     ///< 扫描整个队列清理过期消息
         
         queue<Message> m_msg_queue;
-        mutex m_msg_mutex;
+        mutable mutex m_msg_mutex;
         condition_variable m_msg_cv;
-        thread m_worker_thread;
         bool m_stop_flag;
+        bool m_worker_running;      ///< 分发线程尚未退出循环，受队列锁保护
+        bool m_delete_pending;      ///< 由分发线程退出时自行回收，受队列锁保护
+        vector<int> m_dispatch_cpus;
+        size_t m_trim_threshold;
+        size_t m_trim_watermark;        ///< 上次整队压缩后剩余长度的两倍，超过后才再次压缩
+        atomic<uint64_t> m_expired_count;
+        atomic<bool> m_alive;
+        atomic<int> m_priority;
+        atomic<size_t> m_queued_bytes;              ///< 仅在队列锁内修改
+        atomic<uint64_t> m_shed_count;
+        unordered_map<string, size_t> m_topic_bytes;    ///< 主题 -> 队列中的字节数，受队列锁保护
+        thread m_worker_thread;     ///< 必须最后初始化，确保线程启动时其余成员已就绪
         
         MQSparkAbstract(const MQSparkAbstract&) = delete;
         MQSparkAbstract& operator=(const MQSparkAbstract&) = delete;
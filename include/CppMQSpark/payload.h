@@ -0,0 +1,87 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_PAYLOAD_H
+#define C__MQSPARK_PAYLOAD_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+using namespace std;
+
+namespace MQ
+{
+    /**
+     * @brief 引用计数的只读消息负载
+     * @note 拷贝与切片只增加引用计数，不复制数据；适合在多个订阅者之间传递大块数据。
+     * 底层缓冲区可以来自字符串、调用方提供的内存（带释放回调）或文件映射区域，
+     * 最后一个引用释放时才归还缓冲区
+     * @code{.cpp}
+     * Message msg;
+     * msg.topic_name = "frame";
+     * msg.payload = Payload::Wrap(buf, len, [buf](){ free(buf); });
+     * mqs->PublishMessage(msg);
+     * @endcode
+     */
+    class Payload
+    {
+    public:
+        using ReleaseCallback = function<void()>;
+
+        Payload();
+
+        static Payload FromString(string data);                         ///< 接管字符串，不复制
+        static Payload Copy(const void* data, size_t length);           ///< 复制一份数据
+
+        /**
+         * @brief 包装调用方持有的缓冲区
+         * @param data 缓冲区地址，在 release 被调用前必须保持有效且不被修改
+         * @param length 缓冲区长度
+         * @param release 最后一个引用释放时调用，可为空
+         */
+        static Payload Wrap(const void* data, size_t length, ReleaseCallback release);
+
+        /**
+         * @brief 以只读方式映射文件区域
+         * @param path 文件路径
+         * @param offset 起始偏移
+         * @param length 映射长度，0 表示映射到文件末尾
+         * @throw std::runtime_error 文件无法打开或映射失败
+         * @note 非 POSIX 平台退化为读入内存
+         */
+        static Payload MapFile(const string& path, size_t offset = 0, size_t length = 0);
+
+        /**
+         * @brief 获取子区间，与原负载共享同一缓冲区
+         * @throw std::out_of_range 区间越界
+         */
+        Payload Slice(size_t offset, size_t length) const;
+
+        const char* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+        bool Empty() const { return m_size == 0; }
+        string ToString() const { return string(m_data, m_size); }      ///< 复制为字符串
+        long UseCount() const { return m_buffer.use_count(); }          ///< 共享缓冲区的引用数
+
+    private:
+        Payload(shared_ptr<const char> buffer, const char* data, size_t size);
+
+        shared_ptr<const char> m_buffer;    ///< 持有整个缓冲区的生命周期
+        const char* m_data;
+        size_t m_size;
+    };
+}
+
+#endif//C__MQSPARK_PAYLOAD_H
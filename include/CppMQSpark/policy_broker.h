@@ -0,0 +1,428 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_POLICY_BROKER_H
+#define C__MQSPARK_POLICY_BROKER_H
+
+#include "mqspark_abstract.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * 编译期策略组合的订阅者/代理（仅头文件）
+ * 队列、锁、投递方式和回调类型都是模板参数，投递路径上没有虚函数和 std::function，
+ * 编译器可以把回调完整内联。代价是一个 BasicBroker 只能挂一种订阅者类型，
+ * 且不提供运行时代理的 TTL、延时消息、异步发布和纪元回收等功能
+ */
+namespace MQ
+{
+    namespace Policy
+    {
+        /**
+         * @brief 空锁，仅用于单线程发布/消费
+         */
+        struct NullLock
+        {
+            void lock() {}
+            void unlock() {}
+            bool try_lock() { return true; }
+        };
+
+        /**
+         * @brief 自旋锁，适合临界区极短且竞争不激烈的场景
+         */
+        class SpinLock
+        {
+        public:
+            void lock()
+            {
+                while(m_flag.test_and_set(memory_order_acquire))
+                {
+                    this_thread::yield();
+                }
+            }
+            void unlock() { m_flag.clear(memory_order_release); }
+            bool try_lock() { return !m_flag.test_and_set(memory_order_acquire); }
+        private:
+            atomic_flag m_flag = ATOMIC_FLAG_INIT;
+        };
+
+        using MutexLock = std::mutex;
+
+        /**
+         * @brief 基于 std::deque 的无界队列，与 MQSparkAbstract 内部队列一致
+         */
+        template<typename T>
+        class DequeQueue
+        {
+        public:
+            void Push(const T& value) { m_queue.push_back(value); }
+            void Push(T&& value) { m_queue.push_back(std::move(value)); }
+            bool Pop(T& value)
+            {
+                if(m_queue.empty())
+                {
+                    return false;
+                }
+                value = std::move(m_queue.front());
+                m_queue.pop_front();
+                return true;
+            }
+            bool Empty() const { return m_queue.empty(); }
+            size_t Size() const { return m_queue.size(); }
+        private:
+            deque<T> m_queue;
+        };
+
+        /**
+         * @brief 连续内存环形队列，容量按 2 的幂增长，稳定后入队出队不再分配内存
+         */
+        template<typename T>
+        class RingQueue
+        {
+        public:
+            RingQueue() : m_buffer(16), m_head(0), m_size(0) {}
+
+            void Push(const T& value) { T copy(value); Push(std::move(copy)); }
+            void Push(T&& value)
+            {
+                if(m_size == m_buffer.size())
+                {
+                    grow();
+                }
+                m_buffer[(m_head + m_size) & (m_buffer.size() - 1)] = std::move(value);
+                ++m_size;
+            }
+            bool Pop(T& value)
+            {
+                if(m_size == 0)
+                {
+                    return false;
+                }
+                value = std::move(m_buffer[m_head]);
+                m_head = (m_head + 1) & (m_buffer.size() - 1);
+                --m_size;
+                return true;
+            }
+            bool Empty() const { return m_size == 0; }
+            size_t Size() const { return m_size; }
+        private:
+            void grow()
+            {
+                vector<T> bigger(m_buffer.size() * 2);
+                for(size_t i = 0; i < m_size; ++i)
+                {
+                    bigger[i] = std::move(m_buffer[(m_head + i) & (m_buffer.size() - 1)]);
+                }
+                m_buffer.swap(bigger);
+                m_head = 0;
+            }
+
+            vector<T> m_buffer;
+            size_t m_head;
+            size_t m_size;
+        };
+
+        /**
+         * @brief 调用回调并忽略其中抛出的异常，与 MessageInterface 的分发线程一致，
+         * 单条消息处理失败不影响发布方和后续消息
+         */
+        template<typename Handler>
+        inline void InvokeHandler(Handler& handler, const Message& msg)
+        {
+            try
+            {
+                handler(msg);
+            }
+            catch(const std::exception& e)
+            {
+                (void)e;
+            }
+        }
+
+        /**
+         * @brief 在发布线程中直接调用回调，不经过队列和锁
+         * @note 回调耗时直接计入发布耗时；回调中不要再向同一个代理订阅或取消订阅
+         */
+        struct InlineDelivery
+        {
+            template<typename Handler, template<typename> class Queue, typename Lock>
+            class Impl
+            {
+            public:
+                explicit Impl(Handler handler) : m_handler(std::move(handler)) {}
+                void Deliver(const Message& msg) { InvokeHandler(m_handler, msg); }
+                size_t Pending() const { return 0; }
+            private:
+                Handler m_handler;
+            };
+        };
+
+        /**
+         * @brief 消息入队，由消费者在自己的线程中调用 Poll() 处理
+         */
+        struct PolledDelivery
+        {
+            template<typename Handler, template<typename> class Queue, typename Lock>
+            class Impl
+            {
+            public:
+                explicit Impl(Handler handler) : m_handler(std::move(handler)) {}
+                void Deliver(const Message& msg)
+                {
+                    lock_guard<Lock> lock(m_lock);
+                    m_queue.Push(msg);
+                }
+
+                /**
+                 * @brief 处理队列中的消息
+                 * @param max_count 本次最多处理的条数
+                 * @return 实际处理的条数
+                 */
+                size_t Poll(size_t max_count = static_cast<size_t>(-1))
+                {
+                    size_t handled = 0;
+                    Message msg;
+                    while(handled < max_count)
+                    {
+                        {
+                            lock_guard<Lock> lock(m_lock);
+                            if(!m_queue.Pop(msg))
+                            {
+                                break;
+                            }
+                        }
+                        InvokeHandler(m_handler, msg);
+                        ++handled;
+                    }
+                    return handled;
+                }
+
+                size_t Pending()
+                {
+                    lock_guard<Lock> lock(m_lock);
+                    return m_queue.Size();
+                }
+            private:
+                Handler m_handler;
+                Lock m_lock;
+                Queue<Message> m_queue;
+            };
+        };
+
+        /**
+         * @brief 每个订阅者一个分发线程，与 MessageInterface 的投递方式一致
+         * @note 析构时处理完队列中剩余的消息再退出
+         */
+        struct ThreadedDelivery
+        {
+            template<typename Handler, template<typename> class Queue, typename Lock>
+            class Impl
+            {
+                static_assert(!is_same<Lock, NullLock>::value, "ThreadedDelivery 需要真正的锁");
+            public:
+                explicit Impl(Handler handler)
+                    : m_handler(std::move(handler))
+                    , m_stop(false)
+                    , m_worker(&Impl::loop, this)
+                {}
+                ~Impl()
+                {
+                    {
+                        lock_guard<Lock> lock(m_lock);
+                        m_stop = true;
+                    }
+                    m_cv.notify_one();
+                    m_worker.join();
+                }
+                Impl(const Impl&) = delete;
+                Impl& operator=(const Impl&) = delete;
+
+                void Deliver(const Message& msg)
+                {
+                    {
+                        lock_guard<Lock> lock(m_lock);
+                        m_queue.Push(msg);
+                    }
+                    m_cv.notify_one();
+                }
+
+                size_t Pending()
+                {
+                    lock_guard<Lock> lock(m_lock);
+                    return m_queue.Size();
+                }
+            private:
+                void loop()
+                {
+                    Message msg;
+                    while(true)
+                    {
+                        {
+                            unique_lock<Lock> lock(m_lock);
+                            m_cv.wait(lock, [this](){ return m_stop || !m_queue.Empty(); });
+                            if(!m_queue.Pop(msg))
+                            {
+                                return;     // 已停止且队列为空
+                            }
+                        }
+                        InvokeHandler(m_handler, msg);
+                    }
+                }
+
+                Handler m_handler;
+                Lock m_lock;
+                Queue<Message> m_queue;
+                condition_variable_any m_cv;
+                bool m_stop;
+                thread m_worker;    ///< 最后声明，保证其余成员先构造
+            };
+        };
+    }
+
+    /**
+     * @brief 编译期组合的订阅者
+     * @tparam Handler 回调类型，可以是 lambda、函数对象或 MessageHandle
+     * @tparam Delivery 投递策略：InlineDelivery / PolledDelivery / ThreadedDelivery
+     * @tparam Queue 队列策略：DequeQueue / RingQueue（InlineDelivery 不使用）
+     * @tparam Lock 锁策略：MutexLock / SpinLock / NullLock（InlineDelivery 不使用）
+     * @code{.cpp}
+     * auto sub = MakeSubscriber<Policy::PolledDelivery, Policy::RingQueue>(
+     *     [](const Message& msg) { Process(msg); });
+     * BasicBroker<decltype(sub)::element_type> broker;
+     * broker.Subscribe("orders", *sub);
+     * broker.Publish(Message("o-1", "orders"));
+     * sub->Poll();
+     * @endcode
+     */
+    template<typename Handler,
+             typename Delivery = Policy::ThreadedDelivery,
+             template<typename> class Queue = Policy::DequeQueue,
+             typename Lock = Policy::MutexLock>
+    class BasicSubscriber : public Delivery::template Impl<Handler, Queue, Lock>
+    {
+        using Base = typename Delivery::template Impl<Handler, Queue, Lock>;
+    public:
+        using HandlerType = Handler;
+        using DeliveryType = Delivery;
+
+        explicit BasicSubscriber(Handler handler) : Base(std::move(handler)) {}
+    };
+
+    /**
+     * @brief 创建订阅者，回调类型由参数推导
+     */
+    template<typename Delivery = Policy::ThreadedDelivery,
+             template<typename> class Queue = Policy::DequeQueue,
+             typename Lock = Policy::MutexLock,
+             typename Handler>
+    unique_ptr<BasicSubscriber<Handler, Delivery, Queue, Lock>> MakeSubscriber(Handler handler)
+    {
+        return unique_ptr<BasicSubscriber<Handler, Delivery, Queue, Lock>>(
+            new BasicSubscriber<Handler, Delivery, Queue, Lock>(std::move(handler)));
+    }
+
+    /**
+     * @brief 编译期组合的代理
+     * @tparam Subscriber BasicSubscriber 的某个实例化类型
+     * @tparam Lock 保护主题表的锁，发布期间持有
+     * @warning 订阅者由调用者持有，销毁前必须先 Unsubscribe()
+     */
+    template<typename Subscriber, typename Lock = Policy::MutexLock>
+    class BasicBroker
+    {
+    public:
+        void Subscribe(const string& topic_name, Subscriber& subscriber)
+        {
+            lock_guard<Lock> lock(m_lock);
+            vector<Subscriber*>& subscribers = m_topics[topic_name];
+            if(find(subscribers.begin(), subscribers.end(), &subscriber) == subscribers.end())
+            {
+                subscribers.push_back(&subscriber);
+            }
+        }
+
+        void Unsubscribe(const string& topic_name, Subscriber& subscriber)
+        {
+            lock_guard<Lock> lock(m_lock);
+            auto it = m_topics.find(topic_name);
+            if(it == m_topics.end())
+            {
+                return;
+            }
+            vector<Subscriber*>& subscribers = it->second;
+            subscribers.erase(remove(subscribers.begin(), subscribers.end(), &subscriber), subscribers.end());
+            if(subscribers.empty())
+            {
+                m_topics.erase(it);
+            }
+        }
+
+        void UnsubscribeAll(Subscriber& subscriber)
+        {
+            lock_guard<Lock> lock(m_lock);
+            for(auto it = m_topics.begin(); it != m_topics.end();)
+            {
+                vector<Subscriber*>& subscribers = it->second;
+                subscribers.erase(remove(subscribers.begin(), subscribers.end(), &subscriber), subscribers.end());
+                it = subscribers.empty() ? m_topics.erase(it) : std::next(it);
+            }
+        }
+
+        /**
+         * @brief 发布消息
+         * @return 收到消息的订阅者数量
+         */
+        size_t Publish(const Message& msg)
+        {
+            lock_guard<Lock> lock(m_lock);
+            auto it = m_topics.find(msg.topic_name);
+            if(it == m_topics.end())
+            {
+                return 0;
+            }
+            for(Subscriber* subscriber : it->second)
+            {
+                subscriber->Deliver(msg);
+            }
+            return it->second.size();
+        }
+
+    private:
+        Lock m_lock;
+        unordered_map<string, vector<Subscriber*>> m_topics;
+    };
+
+    /**
+     * @brief 与 MessageInterface 相同配置的实例化：std::function 回调、独立分发线程、deque 队列、互斥锁
+     * @note MessageInterface 需要保持二进制接口和运行时代理功能，仍然是独立实现；
+     * 两者投递开销的差异即策略组合可以省掉的部分
+     */
+    using ClassicSubscriber = BasicSubscriber<MessageHandle, Policy::ThreadedDelivery, Policy::DequeQueue, Policy::MutexLock>;
+    using ClassicBroker = BasicBroker<ClassicSubscriber>;
+}
+
+#endif//C__MQSPARK_POLICY_BROKER_H
@@ -0,0 +1,87 @@
+/*
+* CppMQSpark - 轻量级C++消息队列库 | Lightweight C++ Message Queue Library
+* 版权所有 (C) 2025 Huu-Yuu | Copyright (C) 2025 Huu-Yuu
+*
+* 特此授权任何获得本软件者自由使用、修改、合并、发布及分发本软件的权利，
+* 惟须满足以下条件：
+* 1. 在所有副本中保留上述版权声明及本许可声明
+* 2. 本软件按“原样”提供，无任何担保，作者不承担任何责任
+*
+* Permission is hereby granted to any person obtaining a copy of this software
+* to use, modify, merge, publish, distribute the software, subject to:
+* 1. Retain above copyright notice and this permission notice
+* 2. The software is provided "AS IS" without warranty, authors not liable
+*/
+#ifndef C__MQSPARK_SEQUENCE_TRACKER_H
+#define C__MQSPARK_SEQUENCE_TRACKER_H
+
+#include "mqspark_abstract.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+namespace MQ
+{
+    /**
+     * @brief 订阅端的序列号缺口检测（仅头文件）
+     * @note 代理为每个主题分配从 1 开始连续递增的 headers.sequence，订阅期间出现缺口说明消息
+     * 因 TTL 过期、内存预算丢弃等原因未送达。每条消息只做一次哈希查找和比较。
+     * 以收到的第一条消息为起点，之前的缺失无法识别；序列号回到 1 表示主题在无人订阅期间被重建。
+     * 非线程安全，应在同一个回调线程中使用
+     * @code{.cpp}
+     * SequenceTracker tracker;
+     * mqs->RegMsgHandleCallback([&tracker](const Message& msg) {
+     *     if (tracker.Observe(msg) != 0) RequestReplay(msg.topic_name);
+     * });
+     * @endcode
+     */
+    class SequenceTracker
+    {
+    public:
+        /**
+         * @brief 记录一条消息
+         * @return 该消息之前缺失的条数；未编号、重复或乱序到达的消息返回 0
+         */
+        uint64_t Observe(const Message& msg)
+        {
+            uint64_t sequence = msg.headers.sequence;
+            if(sequence == 0)
+            {
+                return 0;
+            }
+            uint64_t& last = m_last[msg.topic_name];
+            if(last == 0 || sequence == 1)
+            {
+                last = sequence;
+                return 0;
+            }
+            if(sequence <= last)
+            {
+                ++m_stale;
+                return 0;
+            }
+            uint64_t missed = sequence - last - 1;
+            last = sequence;
+            m_missed += missed;
+            return missed;
+        }
+
+        uint64_t LastSequence(const string& topic_name) const
+        {
+            auto it = m_last.find(topic_name);
+            return it == m_last.end() ? 0 : it->second;
+        }
+
+        uint64_t MissedCount() const { return m_missed; }       ///< 累计缺失条数
+        uint64_t StaleCount() const { return m_stale; }         ///< 累计重复/乱序条数
+        void Reset(const string& topic_name) { m_last.erase(topic_name); }
+
+    private:
+        unordered_map<string, uint64_t> m_last;     ///< 主题 -> 最近一条消息的序列号
+        uint64_t m_missed = 0;
+        uint64_t m_stale = 0;
+    };
+}
+
+#endif//C__MQSPARK_SEQUENCE_TRACKER_H
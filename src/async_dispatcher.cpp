@@ -0,0 +1,209 @@
+#include "async_dispatcher.h"
+
+PublishRing::PublishRing(size_t capacity, AsyncDispatcher* dispatcher, size_t worker_index)
+    : m_queue(capacity)
+    , m_pushed(0)
+    , m_published(0)
+    , m_closed(false)
+    , m_dispatcher(dispatcher)
+    , m_worker_index(worker_index)
+{}
+
+void PublishRing::Push(Message&& msg)
+{
+    // 先计数再入队，分发线程休眠前检查计数即可发现尚未入队完成的消息
+    m_pushed.fetch_add(1);
+    while(!m_queue.TryPush(msg))
+    {
+        m_dispatcher->Wake(m_worker_index);
+        this_thread::yield();
+    }
+    if(m_dispatcher->m_workers[m_worker_index]->sleeping.load())
+    {
+        m_dispatcher->Wake(m_worker_index);
+    }
+}
+
+bool PublishRing::Pop(Message& msg)
+{
+    return m_queue.TryPop(msg);
+}
+
+void PublishRing::MarkPublished()
+{
+    m_published.fetch_add(1, memory_order_release);
+}
+
+bool PublishRing::Drained() const
+{
+    return m_published.load(memory_order_acquire) == m_pushed.load();
+}
+
+void PublishRing::Close()
+{
+    m_closed.store(true);
+    m_dispatcher->Wake(m_worker_index);
+}
+
+bool PublishRing::IsClosed() const
+{
+    return m_closed.load();
+}
+
+AsyncDispatcher::AsyncDispatcher(PublishHandle handle, size_t thread_count)
+    : m_handle(std::move(handle))
+    , m_started(false)
+    , m_stop_flag(false)
+    , m_next_worker(0)
+{
+    if(thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    for(size_t i = 0; i < thread_count; ++i)
+    {
+        m_workers.emplace_back(new Worker);
+    }
+}
+
+AsyncDispatcher::~AsyncDispatcher()
+{
+    Stop();
+}
+
+void AsyncDispatcher::Stop()
+{
+    m_stop_flag.store(true);
+    for(size_t i = 0; i < m_workers.size(); ++i)
+    {
+        Wake(i);
+    }
+    for(auto& worker : m_workers)
+    {
+        if(worker->th.joinable())
+        {
+            worker->th.join();
+        }
+    }
+}
+
+shared_ptr<PublishRing> AsyncDispatcher::Register(size_t capacity)
+{
+    start();
+    size_t index = m_next_worker.fetch_add(1) % m_workers.size();
+    auto ring = make_shared<PublishRing>(capacity, this, index);
+    Worker* worker = m_workers[index].get();
+    {
+        lock_guard<mutex> lock(worker->mtx);
+        worker->incoming.push_back(ring);
+        worker->has_incoming.store(true);
+    }
+    Wake(index);
+    return ring;
+}
+
+void AsyncDispatcher::Wake(size_t worker_index)
+{
+    Worker* worker = m_workers[worker_index].get();
+    {
+        lock_guard<mutex> lock(worker->mtx);
+        worker->wake_flag = true;
+    }
+    worker->cv.notify_one();
+}
+
+void AsyncDispatcher::start()
+{
+    lock_guard<mutex> lock(m_start_mtx);
+    if(m_started)
+    {
+        return;
+    }
+    for(auto& worker : m_workers)
+    {
+        worker->th = thread(&AsyncDispatcher::workerLoop, this, worker.get());
+    }
+    m_started = true;
+}
+
+void AsyncDispatcher::workerLoop(Worker* worker)
+{
+    vector<shared_ptr<PublishRing>> rings;
+    int idle_rounds = 0;
+    Message msg;
+    while(true)
+    {
+        if(worker->has_incoming.load())
+        {
+            lock_guard<mutex> lock(worker->mtx);
+            for(auto& ring : worker->incoming)
+            {
+                rings.push_back(std::move(ring));
+            }
+            worker->incoming.clear();
+            worker->has_incoming.store(false);
+        }
+
+        size_t published = 0;
+        for(auto& ring : rings)
+        {
+            for(size_t i = 0; i < kBatch && ring->Pop(msg); ++i)
+            {
+                try
+                {
+                    m_handle(msg);
+                }
+                catch(const std::exception& e)
+                {
+                    // 单条发布失败不影响后续消息
+                    (void)e;
+                }
+                ring->MarkPublished();
+                ++published;
+            }
+        }
+        // 发布者已销毁且消息已发布完的缓冲区直接丢弃
+        for(auto it = rings.begin(); it != rings.end();)
+        {
+            if((*it)->IsClosed() && (*it)->Drained())
+            {
+                it = rings.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if(published != 0)
+        {
+            idle_rounds = 0;
+            continue;
+        }
+        if(m_stop_flag.load())
+        {
+            break;
+        }
+        if(++idle_rounds < kSpinRounds)
+        {
+            this_thread::yield();
+            continue;
+        }
+
+        // 准备休眠：先声明休眠再复查，与发布者的“先计数后检查休眠标记”配对，避免丢失唤醒
+        worker->sleeping.store(true);
+        bool pending = worker->has_incoming.load();
+        for(auto& ring : rings)
+        {
+            pending = pending || !ring->Drained();
+        }
+        if(!pending)
+        {
+            unique_lock<mutex> lock(worker->mtx);
+            worker->cv.wait_for(lock, chrono::milliseconds(100), [worker](){ return worker->wake_flag; });
+            worker->wake_flag = false;
+        }
+        worker->sleeping.store(false);
+        idle_rounds = 0;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef C__MQSPARK_ASYNC_DISPATCHER_H
+#define C__MQSPARK_ASYNC_DISPATCHER_H
+#include "mqspark_abstract.h"
+#include "bounded_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+using namespace MQ;
+
+class AsyncDispatcher;
+
+/*
+ * @brief: 单个发布者的异步发布缓冲区
+ * @note 发布者只做一次无锁入队即返回，路由与扇出由固定的分发线程完成，同一缓冲区只由一个分发线程消费，
+ * 因此同一发布者的消息顺序不变。缓冲区满时发布者让出 CPU 等待（背压）
+ * */
+class PublishRing
+{
+public:
+    PublishRing(size_t capacity, AsyncDispatcher* dispatcher, size_t worker_index);
+
+    void Push(Message&& msg);
+    bool Pop(Message& msg);
+    void MarkPublished();
+    bool Drained() const;                   ///< 已入队的消息全部发布完毕
+    void Close();                           ///< 发布者已销毁，分发线程发布完剩余消息后丢弃
+    bool IsClosed() const;
+
+private:
+    BoundedQueue<Message> m_queue;
+    atomic<uint64_t> m_pushed;
+    atomic<uint64_t> m_published;
+    atomic<bool> m_closed;
+    AsyncDispatcher* m_dispatcher;
+    size_t m_worker_index;
+};
+
+/*
+ * @brief: 异步发布的分发线程池
+ * @note 线程在第一个异步发布者注册时才启动
+ * */
+class AsyncDispatcher
+{
+public:
+    using PublishHandle = function<void(const Message& msg)>;
+
+    AsyncDispatcher(PublishHandle handle, size_t thread_count);
+    ~AsyncDispatcher();
+
+    AsyncDispatcher(const AsyncDispatcher&) = delete;
+    AsyncDispatcher& operator=(const AsyncDispatcher&) = delete;
+
+    shared_ptr<PublishRing> Register(size_t capacity);
+    void Wake(size_t worker_index);             ///< 分发线程休眠时唤醒
+    void Stop();                                ///< 发布完剩余消息后停止分发线程，可重复调用
+
+private:
+    friend class PublishRing;
+    static const size_t kBatch = 64;            ///< 每个缓冲区单轮最多发布的消息数
+    static const int kSpinRounds = 64;          ///< 空闲时休眠前的自旋轮数
+
+    struct Worker
+    {
+        thread th;
+        mutex mtx;
+        condition_variable cv;
+        vector<shared_ptr<PublishRing>> incoming;   ///< 新注册的缓冲区，受 mtx 保护
+        atomic<bool> has_incoming{false};
+        atomic<bool> sleeping{false};
+        bool wake_flag = false;
+    };
+
+    void start();
+    void workerLoop(Worker* worker);
+
+    PublishHandle m_handle;
+    vector<unique_ptr<Worker>> m_workers;
+    mutex m_start_mtx;
+    bool m_started;
+    atomic<bool> m_stop_flag;
+    atomic<size_t> m_next_worker;
+};
+
+
+#endif//C__MQSPARK_ASYNC_DISPATCHER_H
@@ -0,0 +1,44 @@
+#include "broker.h"
+#include "cppmqspark.h"
+
+namespace MQ
+{
+    Broker::Broker(unique_ptr<BrokerImpl> impl)
+        : m_impl(std::move(impl))
+    {}
+
+    Broker::~Broker() = default;
+
+    BrokerPtr Broker::Create(size_t shard_count)
+    {
+        unique_ptr<BrokerImpl> impl(new BrokerImpl);
+        impl->spark_ptr = make_shared<CppMQSpark>(shard_count);
+        return BrokerPtr(new Broker(std::move(impl)));
+    }
+
+    BrokerPtr Broker::Default()
+    {
+        static BrokerPtr instance = []()
+        {
+            unique_ptr<BrokerImpl> impl(new BrokerImpl);
+            impl->spark_ptr = CppMQSpark::GetSharedInstance();
+            return BrokerPtr(new Broker(std::move(impl)));
+        }();
+        return instance;
+    }
+
+    size_t Broker::ShardCount() const
+    {
+        return m_impl->spark_ptr->ShardCount();
+    }
+
+    void Broker::EnableDedup(size_t producer_slots)
+    {
+        m_impl->spark_ptr->EnableDedup(producer_slots);
+    }
+
+    uint64_t Broker::DuplicateCount() const
+    {
+        return m_impl->spark_ptr->DuplicateCount();
+    }
+}
@@ -1,31 +1,153 @@
 #include "cppmqspark.h"
+#include "epoch_reclaimer.h"
 
-CppMQSpark::CppMQSpark() : topic_mgr(TopicManager::GetInstance())
+CppMQSpark::CppMQSpark(size_t shard_count)
+    : async_dispatcher([this](const Message& msg){ PublishMsg(msg); }, shard_count)
+    , timer_wheel([this](Message&& msg){ shardOf(msg.topic_name).PublishMsg(msg, false); })
 {
-
+    if(shard_count == 0)
+    {
+        shard_count = 1;
+    }
+    auto released = [this](MQSparkAbstract* mqs_prt){ onShardReleased(mqs_prt); };
+    for(size_t i = 0; i < shard_count; ++i)
+    {
+        shards.emplace_back(new TopicManager(released));
+    }
 }
 
 CppMQSpark::~CppMQSpark()
 {
+    // 失效订阅者不再持有代理，最后一个使用者释放后代理可能先于它们析构：
+    // 先停止会访问分片的线程，再接管各分片中尚未回收的失效订阅者
+    timer_wheel.Stop();
+    async_dispatcher.Stop();
+    unordered_set<MQSparkAbstract*> pending;
+    for(auto& shard : shards)
+    {
+        for(MQSparkAbstract* dead : shard->TakeDeadClients())
+        {
+            pending.insert(dead);
+        }
+    }
+    for(MQSparkAbstract* dead : pending)
+    {
+        EpochReclaimer::GetInstance().Retire([dead](){ dead->DeleteWhenIdle(); });
+    }
+}
+
+TopicManager& CppMQSpark::shardOf(const string& topic_name)
+{
+    if(shards.size() == 1)
+    {
+        return *shards.front();
+    }
+    return *shards[hash<string>()(topic_name) % shards.size()];
+}
 
+void CppMQSpark::EnableDedup(size_t producer_slots)
+{
+    for(auto& shard : shards)
+    {
+        shard->EnableDedup(producer_slots);
+    }
+}
+
+uint64_t CppMQSpark::DuplicateCount()
+{
+    uint64_t count = 0;
+    for(auto& shard : shards)
+    {
+        count += shard->DuplicateCount();
+    }
+    return count;
+}
+
+shared_ptr<PublishRing> CppMQSpark::RegisterAsyncProducer()
+{
+    return async_dispatcher.Register(kPublishRingSize);
+}
+
+size_t CppMQSpark::ShardCount() const
+{
+    return shards.size();
 }
 
 bool CppMQSpark::ClientSubTopic(const string& topic_name, const MQSparkShPtr& mqs_ptr)
 {
-    return topic_mgr.AddTopic(topic_name, mqs_ptr);
+    return shardOf(topic_name).AddTopic(topic_name, mqs_ptr.get());
 }
 
 bool CppMQSpark::PublishMsg(const Message &msg)
 {
-    return topic_mgr.PublishMsg(msg);
+    return shardOf(msg.topic_name).PublishMsg(msg);
 }
 
 bool CppMQSpark::ClientUnsub(const string &topic_name, const MQSparkShPtr& mqs_prt)
 {
-    return topic_mgr.RemoveTopic(topic_name, mqs_prt);
+    return shardOf(topic_name).RemoveTopic(topic_name, mqs_prt.get());
 }
 
 void CppMQSpark::DelClient(const MQSparkShPtr &mqs_prt)
 {
-    topic_mgr.DelMsgPtr(mqs_prt);
+    for(auto& shard : shards)
+    {
+        shard->DelMsgPtr(mqs_prt.get());
+    }
+}
+
+void CppMQSpark::DelClientNow(MQSparkAbstract* mqs_prt)
+{
+    for(auto& shard : shards)
+    {
+        shard->DelMsgPtr(mqs_prt);
+    }
+    EpochReclaimer::GetInstance().Synchronize();
+}
+
+void CppMQSpark::RetireClient(MQSparkAbstract* mqs_prt)
+{
+    // 每个分片摘除完毕后回调 onShardReleased，全部分片完成才真正回收
+    {
+        lock_guard<mutex> lock(retire_mtx);
+        retiring[mqs_prt] = shards.size();
+    }
+    for(auto& shard : shards)
+    {
+        shard->RetireClient(mqs_prt);
+    }
+}
+
+void CppMQSpark::onShardReleased(MQSparkAbstract* mqs_prt)
+{
+    {
+        lock_guard<mutex> lock(retire_mtx);
+        auto it = retiring.find(mqs_prt);
+        if(it == retiring.end() || --it->second != 0)
+        {
+            return;
+        }
+        retiring.erase(it);
+    }
+    EpochReclaimer::GetInstance().Retire([mqs_prt](){ mqs_prt->DeleteWhenIdle(); });
+}
+
+uint64_t CppMQSpark::SchedulePublish(Message msg, chrono::steady_clock::time_point when)
+{
+    // 定时消息在提交时去重，到期投递时跳过：到期前同一生产者的后续序号可能已把它挤出去重窗口
+    if(shardOf(msg.topic_name).CheckDuplicate(msg))
+    {
+        return 0;
+    }
+    return timer_wheel.Schedule(std::move(msg), when);
+}
+
+bool CppMQSpark::CancelScheduled(uint64_t timer_id)
+{
+    return timer_wheel.Cancel(timer_id);
+}
+
+void CppMQSpark::SetTopicTTL(const string& topic_name, uint32_t ttl_ms)
+{
+    shardOf(topic_name).SetTopicTTL(topic_name, ttl_ms);
 }
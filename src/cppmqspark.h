@@ -1,23 +1,58 @@
 #ifndef C__MQSPARK_CPPMQSPARK_H
 #define C__MQSPARK_CPPMQSPARK_H
 #include "topic_manager.h"
+#include "timer_wheel.h"
+#include "async_dispatcher.h"
+#include "broker.h"
 #include <memory>
+#include <vector>
 #include "public_macro.h"
 
+/*
+ * @brief: 代理实现
+ * @note 默认单例即进程默认代理；也可以直接构造独立实例。主题按名称哈希到 shard_count 个
+ * TopicManager 分片，每个分片有独立的注册表和锁
+ * */
 class CppMQSpark : public std::enable_shared_from_this<CppMQSpark>
 {
     SMART_SINGLETON(CppMQSpark)
 public:
-    CppMQSpark();
+    explicit CppMQSpark(size_t shard_count = 1);
     ~CppMQSpark();
     
     bool ClientSubTopic(const string& topic_name, const MQSparkShPtr& mqs_ptr);
     bool PublishMsg(const Message& msg);
     bool ClientUnsub(const string& topic_name, const MQSparkShPtr& mqs_prt);
     void DelClient(const MQSparkShPtr& mqs_prt);
+    void DelClientNow(MQSparkAbstract* mqs_prt);    ///< 立即摘除并等待发布线程离开，用于析构
+    void RetireClient(MQSparkAbstract* mqs_prt);    ///< 接管已失效订阅者，延迟回收
+    uint64_t SchedulePublish(Message msg, chrono::steady_clock::time_point when);  ///< 判定为重复时返回 0
+    bool CancelScheduled(uint64_t timer_id);
+    void SetTopicTTL(const string& topic_name, uint32_t ttl_ms);
+    void EnableDedup(size_t producer_slots);        ///< 每个分片各自维护去重窗口
+    uint64_t DuplicateCount();
+    shared_ptr<PublishRing> RegisterAsyncProducer();   ///< 为异步发布者分配缓冲区
+    size_t ShardCount() const;
 private:
-    TopicManager& topic_mgr;
+    static const size_t kPublishRingSize = 4096;
+
+    TopicManager& shardOf(const string& topic_name);
+    void onShardReleased(MQSparkAbstract* mqs_prt);
+    
+    vector<unique_ptr<TopicManager>> shards;
+    mutex retire_mtx;
+    unordered_map<MQSparkAbstract*, size_t> retiring;   ///< 失效订阅者 -> 尚未摘除它的分片数
+    AsyncDispatcher async_dispatcher;   ///< 异步发布的分发线程，每个分片一个，析构前发布完剩余消息
+    TimerWheel timer_wheel;     ///< 延时/定时消息，到期后按主题进入对应分片发布
 };
 
 using SmartSpark = shared_ptr<CppMQSpark>;
+
+namespace MQ
+{
+    struct Broker::BrokerImpl
+    {
+        SmartSpark spark_ptr;
+    };
+}
 #endif//C__MQSPARK_CPPMQSPARK_H
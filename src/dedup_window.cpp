@@ -0,0 +1,65 @@
+#include "dedup_window.h"
+
+DedupWindow::DedupWindow(size_t producer_slots)
+    : m_set_mask(0)
+    , m_clock(0)
+{
+    size_t sets = 1;
+    while(sets * kWays < producer_slots)
+    {
+        sets <<= 1;
+    }
+    m_set_mask = sets - 1;
+    m_entries.resize(sets * kWays);
+}
+
+bool DedupWindow::IsDuplicate(uint64_t producer_id, uint64_t producer_seq)
+{
+    // 乘法哈希打散连续分配的生产者 id
+    size_t set = static_cast<size_t>((producer_id * 0x9E3779B97F4A7C15ULL) >> 32) & m_set_mask;
+    Entry* ways = &m_entries[set * kWays];
+    Entry* victim = ways;
+    Entry* entry = nullptr;
+    for(size_t i = 0; i < kWays; ++i)
+    {
+        if(ways[i].producer_id == producer_id)
+        {
+            entry = &ways[i];
+            break;
+        }
+        if(ways[i].last_used < victim->last_used)
+        {
+            victim = &ways[i];
+        }
+    }
+    ++m_clock;
+    if(entry == nullptr)
+    {
+        // 新生产者或已被淘汰，占用组内最久未用的槽位
+        victim->producer_id = producer_id;
+        victim->high = producer_seq;
+        victim->mask = 1;
+        victim->last_used = m_clock;
+        return false;
+    }
+    entry->last_used = m_clock;
+    if(producer_seq > entry->high)
+    {
+        uint64_t shift = producer_seq - entry->high;
+        entry->mask = shift >= kWindow ? 1 : (entry->mask << shift) | 1;
+        entry->high = producer_seq;
+        return false;
+    }
+    uint64_t offset = entry->high - producer_seq;
+    if(offset >= kWindow)
+    {
+        return true;
+    }
+    uint64_t bit = 1ULL << offset;
+    if(entry->mask & bit)
+    {
+        return true;
+    }
+    entry->mask |= bit;
+    return false;
+}
@@ -0,0 +1,41 @@
+#ifndef C__MQSPARK_DEDUP_WINDOW_H
+#define C__MQSPARK_DEDUP_WINDOW_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/*
+ * @brief: 按 (producer_id, producer_seq) 去重的固定大小窗口
+ * @note 生产者按 id 哈希到 4 路组相联的槽位，每个槽位记录该生产者见过的最大序号及其下 kWindow 个序号的位图，
+ * 判断与记录都是 O(1)，内存在构造时一次分配。组内槽位用尽时淘汰最久未出现的生产者，
+ * 被淘汰的生产者随后的重试不再被识别。比窗口更早的序号一律视为重复，生产者重启后应换用新的 id
+ * */
+class DedupWindow
+{
+public:
+    static const uint64_t kWindow = 64;
+
+    explicit DedupWindow(size_t producer_slots);
+
+    bool IsDuplicate(uint64_t producer_id, uint64_t producer_seq);     ///< 非重复时同时记录该序号
+    size_t Capacity() const { return m_entries.size(); }
+
+private:
+    static const size_t kWays = 4;
+
+    struct Entry
+    {
+        uint64_t producer_id = 0;       ///< 0 表示空槽
+        uint64_t high = 0;              ///< 见过的最大序号
+        uint64_t mask = 0;              ///< 第 i 位表示序号 high - i 已出现
+        uint64_t last_used = 0;
+    };
+
+    vector<Entry> m_entries;
+    size_t m_set_mask;
+    uint64_t m_clock;
+};
+
+
+#endif//C__MQSPARK_DEDUP_WINDOW_H
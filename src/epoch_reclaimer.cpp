@@ -0,0 +1,207 @@
+#include "epoch_reclaimer.h"
+#include <thread>
+
+// chrono::milliseconds 按引用接收参数，需要类外定义
+const int EpochReclaimer::kCollectIntervalMs;
+
+struct EpochReclaimer::ThreadSlot
+{
+    Slot* slot = nullptr;
+    int depth = 0;
+    bool overflow = false;
+
+    ~ThreadSlot()
+    {
+        if(slot != nullptr)
+        {
+            slot->epoch.store(0);
+            slot->used.store(false);
+        }
+    }
+};
+
+EpochReclaimer::EpochReclaimer()
+    : m_global_epoch(1)
+    , m_overflow_readers(0)
+    , m_stop_flag(false)
+    , m_reclaim_thread(&EpochReclaimer::reclaimLoop, this)
+{}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    {
+        lock_guard<mutex> lock(m_retire_mtx);
+        m_stop_flag = true;
+    }
+    m_retire_cv.notify_one();
+    if(m_reclaim_thread.joinable())
+    {
+        m_reclaim_thread.join();
+    }
+    // 进程退出时不再有读者，直接释放剩余对象
+    vector<Retired> retired;
+    {
+        lock_guard<mutex> lock(m_retire_mtx);
+        retired.swap(m_retired);
+    }
+    for(auto& item : retired)
+    {
+        item.deleter();
+    }
+}
+
+EpochReclaimer::ThreadSlot& EpochReclaimer::localSlot()
+{
+    static thread_local ThreadSlot holder;
+    if(holder.slot == nullptr && !holder.overflow)
+    {
+        for(auto& slot : m_slots)
+        {
+            bool expected = false;
+            if(slot.used.compare_exchange_strong(expected, true))
+            {
+                holder.slot = &slot;
+                break;
+            }
+        }
+        // 槽位用尽的线程退化为共享计数
+        holder.overflow = holder.slot == nullptr;
+    }
+    return holder;
+}
+
+EpochReclaimer::Guard::Guard()
+    : m_holder(EpochReclaimer::GetInstance().localSlot())
+{
+    if(m_holder.depth++ != 0)
+    {
+        return;
+    }
+    EpochReclaimer& reclaimer = EpochReclaimer::GetInstance();
+    if(m_holder.overflow)
+    {
+        reclaimer.m_overflow_readers.fetch_add(1);
+        return;
+    }
+    m_holder.slot->epoch.store(reclaimer.m_global_epoch.load());
+}
+
+EpochReclaimer::Guard::~Guard()
+{
+    if(--m_holder.depth != 0)
+    {
+        return;
+    }
+    if(m_holder.overflow)
+    {
+        EpochReclaimer::GetInstance().m_overflow_readers.fetch_sub(1);
+        return;
+    }
+    m_holder.slot->epoch.store(0);
+}
+
+void EpochReclaimer::Retire(function<void()> deleter)
+{
+    // 只登记不回收：调用方可能持有代理锁，或者运行在 deleter 将要析构的代理线程上
+    bool notify;
+    {
+        lock_guard<mutex> lock(m_retire_mtx);
+        // 记录摘链时的纪元并推进全局纪元，之后进入的读者看不到该对象
+        m_retired.push_back(Retired{m_global_epoch.fetch_add(1), std::move(deleter)});
+        notify = m_retired.size() == 1 || m_retired.size() >= kCollectBatch;
+    }
+    if(notify)
+    {
+        m_retire_cv.notify_one();
+    }
+}
+
+void EpochReclaimer::reclaimLoop()
+{
+    while(true)
+    {
+        {
+            unique_lock<mutex> lock(m_retire_mtx);
+            // 空闲时一直休眠；有待回收对象时攒满一批或等待一个周期
+            m_retire_cv.wait(lock, [this](){ return m_stop_flag || !m_retired.empty(); });
+            m_retire_cv.wait_for(lock, chrono::milliseconds(kCollectIntervalMs), [this](){
+                return m_stop_flag || m_retired.size() >= kCollectBatch;
+            });
+            if(m_stop_flag)
+            {
+                break;
+            }
+        }
+        Collect();
+    }
+}
+
+uint64_t EpochReclaimer::minActiveEpoch()
+{
+    uint64_t min_epoch = UINT64_MAX;
+    for(auto& slot : m_slots)
+    {
+        uint64_t epoch = slot.epoch.load();
+        if(epoch != 0 && epoch < min_epoch)
+        {
+            min_epoch = epoch;
+        }
+    }
+    return min_epoch;
+}
+
+size_t EpochReclaimer::Collect()
+{
+    vector<Retired> ready;
+    {
+        lock_guard<mutex> lock(m_retire_mtx);
+        if(m_retired.empty() || m_overflow_readers.load() != 0)
+        {
+            return 0;
+        }
+        uint64_t min_epoch = minActiveEpoch();
+        auto keep = m_retired.begin();
+        for(auto it = m_retired.begin(); it != m_retired.end(); ++it)
+        {
+            if(it->epoch < min_epoch)
+            {
+                ready.emplace_back(std::move(*it));
+            }
+            else
+            {
+                if(keep != it)
+                {
+                    *keep = std::move(*it);
+                }
+                ++keep;
+            }
+        }
+        m_retired.erase(keep, m_retired.end());
+    }
+    // 在锁外执行，deleter 内部可以再次 Retire
+    for(auto& item : ready)
+    {
+        item.deleter();
+    }
+    return ready.size();
+}
+
+void EpochReclaimer::Synchronize()
+{
+    uint64_t target = m_global_epoch.fetch_add(1);
+    while(true)
+    {
+        uint64_t min_epoch = minActiveEpoch();
+        if(min_epoch > target && m_overflow_readers.load() == 0)
+        {
+            break;
+        }
+        this_thread::yield();
+    }
+}
+
+size_t EpochReclaimer::PendingCount()
+{
+    lock_guard<mutex> lock(m_retire_mtx);
+    return m_retired.size();
+}
@@ -0,0 +1,82 @@
+#ifndef C__MQSPARK_EPOCH_RECLAIMER_H
+#define C__MQSPARK_EPOCH_RECLAIMER_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/*
+ * @brief: 基于纪元的延迟回收
+ * @note 发布路径进入 Guard 后可以安全地读取无锁快照和订阅者裸指针，进入/离开只写本线程独占的
+ * 缓存行，不产生共享的引用计数。写方先摘链再 Retire()，待所有在摘链前进入的读者离开后才真正释放。
+ * 释放统一在后台回收线程中执行：deleter 可能析构整个代理，不能在调用方持有的代理锁内或代理自己的线程上运行
+ * */
+class EpochReclaimer
+{
+    struct ThreadSlot;
+public:
+    static EpochReclaimer& GetInstance()
+    {
+        static EpochReclaimer instance;
+        return instance;
+    }
+
+    /*
+     * @brief: 读侧临界区，支持同一线程嵌套
+     * */
+    class Guard
+    {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    private:
+        ThreadSlot& m_holder;
+    };
+
+    void Retire(function<void()> deleter);  ///< 对象已不可达后调用，deleter 在宽限期结束后由回收线程执行
+    size_t Collect();                       ///< 释放已过宽限期的对象，返回释放数量；不要在代理锁内调用
+    void Synchronize();                     ///< 阻塞直到当前所有读者离开，不执行 deleter
+    size_t PendingCount();
+
+private:
+    static const int kMaxSlots = 256;
+    static const size_t kCollectBatch = 64;     ///< 待回收数量达到该值时立即唤醒回收线程
+    static const int kCollectIntervalMs = 10;   ///< 不足一批时回收线程的最长等待时间
+
+    struct alignas(64) Slot
+    {
+        atomic<uint64_t> epoch{0};      ///< 0 表示不在临界区
+        atomic<bool> used{false};
+    };
+    struct Retired
+    {
+        uint64_t epoch;
+        function<void()> deleter;
+    };
+    EpochReclaimer();
+    ~EpochReclaimer();
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    ThreadSlot& localSlot();
+    uint64_t minActiveEpoch();
+    void reclaimLoop();
+
+    Slot m_slots[kMaxSlots];
+    atomic<uint64_t> m_global_epoch;
+    atomic<int> m_overflow_readers;     ///< 槽位用尽时的读者，存在时暂停回收
+    mutex m_retire_mtx;
+    condition_variable m_retire_cv;
+    vector<Retired> m_retired;
+    bool m_stop_flag;
+    thread m_reclaim_thread;    ///< 最后初始化
+};
+
+
+#endif//C__MQSPARK_EPOCH_RECLAIMER_H
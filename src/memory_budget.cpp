@@ -0,0 +1,280 @@
+#include "memory_budget.h"
+#include "mqspark_abstract.h"
+#include <algorithm>
+
+namespace MQ
+{
+    namespace
+    {
+        thread_local size_t t_fanout_credit = 0;   ///< 当前线程已预留、尚未被入队扣除的字节数
+    }
+    
+    MemoryBudget::MemoryBudget()
+        : m_total(0)
+        , m_limit(0)
+        , m_shed_count(0)
+        , m_policy(OverflowPolicy::Backpressure)
+        , m_max_block_ms(100)
+        , m_waiters(0)
+    {}
+
+    void MemoryBudget::SetLimit(size_t bytes)
+    {
+        m_limit.store(bytes);
+        // 放宽上限后唤醒等待中的发布线程
+        lock_guard<mutex> lock(m_wait_mtx);
+        m_wait_cv.notify_all();
+    }
+
+    size_t MemoryBudget::GetLimit() const
+    {
+        return m_limit.load();
+    }
+
+    void MemoryBudget::SetPolicy(OverflowPolicy policy, chrono::milliseconds max_block)
+    {
+        m_policy.store(policy);
+        m_max_block_ms.store(max_block.count());
+    }
+
+    OverflowPolicy MemoryBudget::GetPolicy() const
+    {
+        return m_policy.load();
+    }
+
+    size_t MemoryBudget::QueuedBytes() const
+    {
+        return m_total.load(memory_order_relaxed);
+    }
+
+    uint64_t MemoryBudget::ShedCount() const
+    {
+        return m_shed_count.load(memory_order_relaxed);
+    }
+
+    size_t MemoryBudget::TopicQueuedBytes(const string &topic_name)
+    {
+        size_t bytes = 0;
+        lock_guard<mutex> lock(m_registry_mtx);
+        for(MQSparkAbstract* subscriber : m_subscribers)
+        {
+            lock_guard<mutex> queue_lock(subscriber->m_msg_mutex);
+            auto it = subscriber->m_topic_bytes.find(topic_name);
+            if(it != subscriber->m_topic_bytes.end())
+            {
+                bytes += it->second;
+            }
+        }
+        return bytes;
+    }
+
+    unordered_map<string, size_t> MemoryBudget::TopicUsage()
+    {
+        unordered_map<string, size_t> usage;
+        lock_guard<mutex> lock(m_registry_mtx);
+        for(MQSparkAbstract* subscriber : m_subscribers)
+        {
+            lock_guard<mutex> queue_lock(subscriber->m_msg_mutex);
+            for(const auto& item : subscriber->m_topic_bytes)
+            {
+                if(item.second != 0)
+                {
+                    usage[item.first] += item.second;
+                }
+            }
+        }
+        return usage;
+    }
+
+    vector<SubscriberMemory> MemoryBudget::SubscriberUsage()
+    {
+        vector<SubscriberMemory> usage;
+        lock_guard<mutex> lock(m_registry_mtx);
+        usage.reserve(m_subscribers.size());
+        for(MQSparkAbstract* subscriber : m_subscribers)
+        {
+            SubscriberMemory item;
+            item.subscriber = subscriber;
+            item.priority = subscriber->GetPriority();
+            item.shed_count = subscriber->GetShedCount();
+            {
+                lock_guard<mutex> queue_lock(subscriber->m_msg_mutex);
+                item.queued_bytes = subscriber->m_queued_bytes.load(memory_order_relaxed);
+                item.queued_messages = subscriber->m_msg_queue.size();
+            }
+            usage.push_back(item);
+        }
+        return usage;
+    }
+
+    size_t MemoryBudget::MessageBytes(const Message &msg)
+    {
+        size_t bytes = sizeof(Message) + msg.content.size() + msg.topic_name.size() + msg.payload.Size();
+        if(!msg.headers.IsInline())
+        {
+            bytes += msg.headers.Block().Bytes().size;
+        }
+        return bytes;
+    }
+
+    void MemoryBudget::Register(MQSparkAbstract *subscriber)
+    {
+        lock_guard<mutex> lock(m_registry_mtx);
+        m_subscribers.insert(subscriber);
+    }
+
+    void MemoryBudget::Unregister(MQSparkAbstract *subscriber)
+    {
+        lock_guard<mutex> lock(m_registry_mtx);
+        m_subscribers.erase(subscriber);
+    }
+
+    bool MemoryBudget::Acquire(MQSparkAbstract *subscriber, size_t bytes)
+    {
+        // 调用方可能持有分片锁，这里不能等待：Backpressure 的等待已在取锁前由 FanoutReservation 完成
+        if(t_fanout_credit >= bytes)
+        {
+            t_fanout_credit -= bytes;
+            return true;
+        }
+        size_t limit = m_limit.load(memory_order_relaxed);
+        if(limit == 0)
+        {
+            m_total.fetch_add(bytes, memory_order_relaxed);
+            return true;
+        }
+        if(tryReserve(bytes, limit))
+        {
+            return true;
+        }
+        bool admitted = m_policy.load() == OverflowPolicy::ShedLowestPriority
+                        && shedFor(subscriber, bytes, limit);
+        if(!admitted)
+        {
+            m_shed_count.fetch_add(1, memory_order_relaxed);
+        }
+        return admitted;
+    }
+
+    void MemoryBudget::Release(size_t bytes)
+    {
+        m_total.fetch_sub(bytes);
+        if(m_waiters.load() != 0)
+        {
+            lock_guard<mutex> lock(m_wait_mtx);
+            m_wait_cv.notify_all();
+        }
+    }
+
+    bool MemoryBudget::FanoutReservation::Needed()
+    {
+        MemoryBudget& budget = GetInstance();
+        return budget.m_limit.load(memory_order_relaxed) != 0
+               && budget.m_policy.load() == OverflowPolicy::Backpressure;
+    }
+    
+    void MemoryBudget::FanoutReservation::Reserve(size_t bytes)
+    {
+        MemoryBudget& budget = GetInstance();
+        size_t limit = budget.m_limit.load(memory_order_relaxed);
+        if(bytes == 0 || limit == 0)
+        {
+            return;
+        }
+        // 超时未预留成功时不记额度，锁内逐个订阅者做不等待的申请
+        if(budget.tryReserve(bytes, limit) || budget.waitForSpace(bytes, limit))
+        {
+            m_reserved += bytes;
+            t_fanout_credit += bytes;
+        }
+    }
+    
+    MemoryBudget::FanoutReservation::~FanoutReservation()
+    {
+        size_t unused = min(m_reserved, t_fanout_credit);
+        if(unused != 0)
+        {
+            t_fanout_credit -= unused;
+            GetInstance().Release(unused);
+        }
+    }
+    
+    bool MemoryBudget::tryReserve(size_t bytes, size_t limit)
+    {
+        size_t current = m_total.load(memory_order_relaxed);
+        while(current + bytes <= limit)
+        {
+            if(m_total.compare_exchange_weak(current, current + bytes))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool MemoryBudget::waitForSpace(size_t bytes, size_t limit)
+    {
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(m_max_block_ms.load());
+        unique_lock<mutex> lock(m_wait_mtx);
+        // 先登记再检查，与 Release() 的“先归还再检查等待者”配对，避免丢失唤醒
+        m_waiters.fetch_add(1);
+        bool admitted = false;
+        while(true)
+        {
+            limit = m_limit.load();
+            if(limit == 0)
+            {
+                m_total.fetch_add(bytes, memory_order_relaxed);
+                admitted = true;
+                break;
+            }
+            if(tryReserve(bytes, limit))
+            {
+                admitted = true;
+                break;
+            }
+            if(m_wait_cv.wait_until(lock, deadline) == cv_status::timeout)
+            {
+                admitted = tryReserve(bytes, m_limit.load());
+                break;
+            }
+        }
+        m_waiters.fetch_sub(1);
+        return admitted;
+    }
+
+    bool MemoryBudget::shedFor(MQSparkAbstract *subscriber, size_t bytes, size_t limit)
+    {
+        // 调用方未持有任何订阅者的队列锁，包括 subscriber 自身
+        int priority = subscriber->GetPriority();
+        lock_guard<mutex> lock(m_registry_mtx);
+        vector<MQSparkAbstract*> victims;
+        for(MQSparkAbstract* candidate : m_subscribers)
+        {
+            if(candidate->GetPriority() <= priority && candidate->m_queued_bytes.load(memory_order_relaxed) != 0)
+            {
+                victims.push_back(candidate);
+            }
+        }
+        // 优先级低的先丢；同优先级先丢积压最多的
+        sort(victims.begin(), victims.end(), [](MQSparkAbstract* a, MQSparkAbstract* b){
+            if(a->GetPriority() != b->GetPriority())
+            {
+                return a->GetPriority() < b->GetPriority();
+            }
+            return a->m_queued_bytes.load(memory_order_relaxed) > b->m_queued_bytes.load(memory_order_relaxed);
+        });
+        for(MQSparkAbstract* victim : victims)
+        {
+            while(victim->shedOldest())
+            {
+                m_shed_count.fetch_add(1, memory_order_relaxed);
+                if(tryReserve(bytes, limit))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
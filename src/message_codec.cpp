@@ -0,0 +1,112 @@
+#include "message_codec.h"
+#include "varint.h"
+
+namespace MQ
+{
+    namespace
+    {
+        void putVarint(string& out, uint64_t value)
+        {
+            char buf[Varint::kMaxBytes];
+            out.append(buf, Varint::Encode(value, buf));
+        }
+
+        void putBytes(string& out, const char* data, size_t size)
+        {
+            putVarint(out, size);
+            if(size != 0)
+            {
+                out.append(data, size);
+            }
+        }
+    }
+
+    void MessageCodec::Encode(const Message& msg, string& out)
+    {
+        ByteView block = msg.headers.Block().Bytes();
+        out.reserve(out.size() + 1 + 9 * Varint::kMaxBytes
+            + msg.topic_name.size() + block.size + msg.content.size() + msg.payload.Size());
+
+        out.push_back(static_cast<char>(kVersion));
+        putVarint(out, static_cast<uint64_t>(msg.headers.publish_time_us));
+        putVarint(out, msg.headers.sequence);
+        putVarint(out, msg.headers.producer_id);
+        putVarint(out, msg.headers.producer_seq);
+        putVarint(out, msg.ttl_ms);
+        putBytes(out, msg.topic_name.data(), msg.topic_name.size());
+        putBytes(out, block.data, block.size);
+        putBytes(out, msg.content.data(), msg.content.size());
+        putBytes(out, msg.payload.Data(), msg.payload.Size());
+    }
+
+    string MessageCodec::Encode(const Message& msg)
+    {
+        string out;
+        Encode(msg, out);
+        return out;
+    }
+
+    MessageView::MessageView(const char* data, size_t size)
+        : m_valid(false)
+        , m_encoded_size(0)
+        , m_publish_time_us(0)
+        , m_sequence(0)
+        , m_producer_id(0)
+        , m_producer_seq(0)
+        , m_ttl_ms(0)
+    {
+        if(data == nullptr || size == 0)
+        {
+            return;
+        }
+        uint8_t version = static_cast<uint8_t>(data[0]);
+        if(version != MessageCodec::kVersion)
+        {
+            return;
+        }
+        const char* pos = data + 1;
+        const char* end = data + size;
+        uint64_t publish_time = 0;
+        uint64_t ttl = 0;
+        if(!Varint::Decode(pos, end, publish_time)
+            || !Varint::Decode(pos, end, m_sequence)
+            || !Varint::Decode(pos, end, m_producer_id)
+            || !Varint::Decode(pos, end, m_producer_seq)
+            || !Varint::Decode(pos, end, ttl)
+            || !Varint::DecodeBytes(pos, end, m_topic.data, m_topic.size)
+            || !Varint::DecodeBytes(pos, end, m_headers.data, m_headers.size)
+            || !Varint::DecodeBytes(pos, end, m_content.data, m_content.size)
+            || !Varint::DecodeBytes(pos, end, m_payload.data, m_payload.size))
+        {
+            return;
+        }
+        // 头部块格式不完整时整条消息无效，避免 ToMessage() 把坏块带进 MessageHeaders
+        if(!HeaderBlockView(m_headers.data, m_headers.size).IsValid())
+        {
+            return;
+        }
+        m_publish_time_us = static_cast<int64_t>(publish_time);
+        m_ttl_ms = static_cast<uint32_t>(ttl);
+        m_encoded_size = static_cast<size_t>(pos - data);
+        m_valid = true;
+    }
+
+    Message MessageView::ToMessage() const
+    {
+        Message msg;
+        if(!m_valid)
+        {
+            return msg;
+        }
+        msg.topic_name = m_topic.ToString();
+        msg.content = m_content.ToString();
+        msg.payload = Payload::Copy(m_payload.data, m_payload.size);
+        msg.ttl_ms = m_ttl_ms;
+        msg.headers.publish_time_us = m_publish_time_us;
+        msg.headers.sequence = m_sequence;
+        msg.headers.producer_id = m_producer_id;
+        msg.headers.producer_seq = m_producer_seq;
+        msg.headers.AssignBlock(m_headers);
+        return msg;
+    }
+}
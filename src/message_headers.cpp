@@ -0,0 +1,248 @@
+#include "message_headers.h"
+#include "varint.h"
+
+namespace MQ
+{
+    ByteView HeaderBlockView::Key() const
+    {
+        const char* pos = m_data;
+        const char* end = m_data + m_size;
+        ByteView key;
+        if(m_size == 0 || !Varint::DecodeBytes(pos, end, key.data, key.size))
+        {
+            return ByteView();
+        }
+        return key;
+    }
+
+    bool HeaderBlockView::Find(ByteView name, ByteView& value) const
+    {
+        const char* pos = m_data;
+        const char* end = m_data + m_size;
+        ByteView key;
+        if(m_size == 0 || !Varint::DecodeBytes(pos, end, key.data, key.size))
+        {
+            return false;
+        }
+        while(pos < end)
+        {
+            ByteView n, v;
+            if(!Varint::DecodeBytes(pos, end, n.data, n.size) || !Varint::DecodeBytes(pos, end, v.data, v.size))
+            {
+                return false;
+            }
+            if(n == name)
+            {
+                value = v;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void HeaderBlockView::ForEach(const Visitor& visitor) const
+    {
+        const char* pos = m_data;
+        const char* end = m_data + m_size;
+        ByteView key;
+        if(m_size == 0 || !Varint::DecodeBytes(pos, end, key.data, key.size))
+        {
+            return;
+        }
+        while(pos < end)
+        {
+            ByteView n, v;
+            if(!Varint::DecodeBytes(pos, end, n.data, n.size) || !Varint::DecodeBytes(pos, end, v.data, v.size))
+            {
+                return;
+            }
+            visitor(n, v);
+        }
+    }
+
+    size_t HeaderBlockView::Count() const
+    {
+        size_t count = 0;
+        ForEach([&count](ByteView, ByteView){ ++count; });
+        return count;
+    }
+
+    bool HeaderBlockView::IsValid() const
+    {
+        if(m_size == 0)
+        {
+            return true;
+        }
+        const char* pos = m_data;
+        const char* end = m_data + m_size;
+        ByteView key;
+        if(!Varint::DecodeBytes(pos, end, key.data, key.size))
+        {
+            return false;
+        }
+        while(pos < end)
+        {
+            ByteView n, v;
+            if(!Varint::DecodeBytes(pos, end, n.data, n.size) || !Varint::DecodeBytes(pos, end, v.data, v.size))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MessageHeaders::MessageHeaders()
+        : m_size(0)
+        , m_capacity(kInlineSize)
+    {}
+
+    MessageHeaders::MessageHeaders(const MessageHeaders& other)
+        : MessageHeaders()
+    {
+        *this = other;
+    }
+
+    MessageHeaders::MessageHeaders(MessageHeaders&& other) noexcept
+        : MessageHeaders()
+    {
+        *this = std::move(other);
+    }
+
+    MessageHeaders& MessageHeaders::operator=(const MessageHeaders& other)
+    {
+        if(this != &other)
+        {
+            publish_time_us = other.publish_time_us;
+            sequence = other.sequence;
+            producer_id = other.producer_id;
+            producer_seq = other.producer_seq;
+            m_size = 0;
+            append(other.data(), other.m_size);
+        }
+        return *this;
+    }
+
+    MessageHeaders& MessageHeaders::operator=(MessageHeaders&& other) noexcept
+    {
+        if(this != &other)
+        {
+            publish_time_us = other.publish_time_us;
+            sequence = other.sequence;
+            producer_id = other.producer_id;
+            producer_seq = other.producer_seq;
+            if(other.m_heap)
+            {
+                // 堆上数据直接接管
+                m_heap = std::move(other.m_heap);
+                m_capacity = other.m_capacity;
+            }
+            else
+            {
+                m_heap.reset();
+                m_capacity = kInlineSize;
+                memcpy(m_inline, other.m_inline, other.m_size);
+            }
+            m_size = other.m_size;
+            other.m_size = 0;
+            other.m_capacity = kInlineSize;
+        }
+        return *this;
+    }
+
+    void MessageHeaders::SetKey(ByteView key)
+    {
+        // 路由键位于块首，替换时保留后面的键值对；旧键无法解码时整块丢弃
+        size_t prefix = 0;
+        if(m_size != 0)
+        {
+            const char* pos = data();
+            ByteView old_key;
+            prefix = Varint::DecodeBytes(pos, data() + m_size, old_key.data, old_key.size)
+                     ? static_cast<size_t>(pos - data())
+                     : m_size;
+        }
+        char len_buf[Varint::kMaxBytes];
+        size_t len_size = Varint::Encode(key.size, len_buf);
+        size_t head = len_size + key.size;
+        size_t tail = m_size - prefix;
+        // 新键来自自身缓冲区时先复制出来，否则下面的搬移会覆盖它；一般不会走到这里
+        string alias;
+        if(key.size != 0 && key.data >= data() && key.data < data() + m_size)
+        {
+            alias.assign(key.data, key.size);
+            key = ByteView(alias.data(), alias.size());
+        }
+        // 原地把后面的键值对挪到新键之后，不经过临时缓冲
+        reserve(head + tail);
+        char* buf = data();
+        memmove(buf + head, buf + prefix, tail);
+        memcpy(buf, len_buf, len_size);
+        if(key.size != 0)
+        {
+            memcpy(buf + len_size, key.data, key.size);
+        }
+        m_size = head + tail;
+    }
+
+    void MessageHeaders::Add(ByteView name, ByteView value)
+    {
+        if(m_size == 0)
+        {
+            appendVarint(0);    // 空路由键占位
+        }
+        appendVarint(name.size);
+        append(name.data, name.size);
+        appendVarint(value.size);
+        append(value.data, value.size);
+    }
+
+    void MessageHeaders::Clear()
+    {
+        publish_time_us = 0;
+        sequence = 0;
+        producer_id = 0;
+        producer_seq = 0;
+        m_size = 0;
+    }
+
+    bool MessageHeaders::AssignBlock(ByteView block)
+    {
+        m_size = 0;
+        if(!HeaderBlockView(block.data, block.size).IsValid())
+        {
+            return false;
+        }
+        append(block.data, block.size);
+        return true;
+    }
+
+    void MessageHeaders::reserve(size_t capacity)
+    {
+        if(capacity <= m_capacity)
+        {
+            return;
+        }
+        size_t new_capacity = m_capacity * 2 > capacity ? m_capacity * 2 : capacity;
+        unique_ptr<char[]> heap(new char[new_capacity]);
+        memcpy(heap.get(), data(), m_size);
+        m_heap = std::move(heap);
+        m_capacity = new_capacity;
+    }
+
+    void MessageHeaders::append(const char* bytes, size_t n)
+    {
+        if(n == 0)
+        {
+            return;
+        }
+        reserve(m_size + n);
+        memcpy(data() + m_size, bytes, n);
+        m_size += n;
+    }
+
+    void MessageHeaders::appendVarint(uint64_t value)
+    {
+        char buf[Varint::kMaxBytes];
+        append(buf, Varint::Encode(value, buf));
+    }
+}
@@ -54,6 +54,10 @@ namespace MQ
             // 重置消息内容
             msg->content.clear();
             msg->topic_name.clear();
+            msg->payload = Payload();
+            msg->headers.Clear();
+            msg->ttl_ms = 0;
+            msg->expire_at = std::chrono::steady_clock::time_point();
             
             std::lock_guard<std::mutex> lock(m_mutex);
             
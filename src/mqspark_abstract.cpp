@@ -1,52 +1,178 @@
 #include "mqspark_abstract.h"
+#include "cpu_affinity.h"
 
 namespace MQ
 {
     MQSparkAbstract::MQSparkAbstract()
         : m_stop_flag(false)
+        , m_worker_running(true)
+        , m_delete_pending(false)
+        , m_trim_threshold(0)
+        , m_trim_watermark(0)
+        , m_expired_count(0)
+        , m_alive(true)
+        , m_priority(0)
+        , m_queued_bytes(0)
+        , m_shed_count(0)
         , m_worker_thread(&MQSparkAbstract::messageProcessLoop, this)
-    {}
+    {
+        MemoryBudget::GetInstance().Register(this);
+    }
     
     MQSparkAbstract::~MQSparkAbstract()
     {
-        // 停止工作线程
+        // 停止工作线程，处理完剩余消息后退出
+        StopDispatch(false);
+        // 停止后仍可能有发布线程入队，归还这部分预算
+        {
+            lock_guard<mutex> lock(m_msg_mutex);
+            clearLocked();
+        }
+        MemoryBudget::GetInstance().Unregister(this);
+    }
+    
+    void MQSparkAbstract::Retire()
+    {
+        StopDispatch(true);
+        DeleteWhenIdle();
+    }
+    
+    void MQSparkAbstract::DeleteWhenIdle()
+    {
+        {
+            lock_guard<mutex> lock(m_msg_mutex);
+            if(m_worker_running)
+            {
+                // 分发线程已分离且仍在回调中，交给它在退出循环后回收
+                m_delete_pending = true;
+                return;
+            }
+        }
+        delete this;
+    }
+    
+    void MQSparkAbstract::SetHandle(MessageHandle handle)
+    {
+        lock_guard<mutex> lock(m_msg_mutex);
+        m_handle_ = std::move(handle);
+    }
+    
+    void MQSparkAbstract::StopDispatch(bool discard_pending)
+    {
+        m_alive.store(false, memory_order_release);
         {
             lock_guard<mutex> lock(m_msg_mutex);
             m_stop_flag = true;
+            if(discard_pending)
+            {
+                clearLocked();
+            }
         }
         m_msg_cv.notify_one();
         
         if(m_worker_thread.joinable())
         {
-            m_worker_thread.join();
+            // 在自身回调中释放了最后一个引用时无法 join 自身，只能分离，此时回调返回前对象不得被回收
+            if(m_worker_thread.get_id() == this_thread::get_id())
+            {
+                m_worker_thread.detach();
+            }
+            else
+            {
+                m_worker_thread.join();
+            }
         }
     }
     
     void MQSparkAbstract::HandleMessage(const Message &msg)
     {
-        // 将消息加入队列，异步处理
-        {
-            lock_guard<mutex> lock(m_msg_mutex);
-            m_msg_queue.emplace(msg);
-        }
-        m_msg_cv.notify_one();
+        // 在锁外完成拷贝，缩短临界区
+        enqueue(Message(msg));
     }
     
     void MQSparkAbstract::HandleMessage(Message&& msg)
     {
         // 将消息移动加入队列，减少拷贝
+        enqueue(std::move(msg));
+    }
+    
+    void MQSparkAbstract::enqueue(Message&& msg)
+    {
+        // 入队前向内存预算申请，此时不能持有自身队列锁，超出预算时可能需要丢弃自身的旧消息
+        size_t bytes = MemoryBudget::MessageBytes(msg);
+        if(!MemoryBudget::GetInstance().Acquire(this, bytes))
+        {
+            m_shed_count.fetch_add(1, memory_order_relaxed);
+            return;
+        }
         {
             lock_guard<mutex> lock(m_msg_mutex);
-            m_msg_queue.emplace(std::move(msg));
+            enqueueLocked(std::move(msg), bytes);
+            if(m_trim_threshold != 0 && m_msg_queue.size() > m_trim_threshold
+               && m_msg_queue.size() > m_trim_watermark)
+            {
+                compactExpired(chrono::steady_clock::now());
+            }
         }
         m_msg_cv.notify_one();
     }
     
+    void MQSparkAbstract::enqueueLocked(Message&& msg, size_t bytes)
+    {
+        m_topic_bytes[msg.topic_name] += bytes;
+        m_queued_bytes.store(m_queued_bytes.load(memory_order_relaxed) + bytes, memory_order_relaxed);
+        m_msg_queue.emplace(std::move(msg));
+    }
+    
+    void MQSparkAbstract::popFrontLocked(Message* out)
+    {
+        Message& front = m_msg_queue.front();
+        size_t bytes = MemoryBudget::MessageBytes(front);
+        auto it = m_topic_bytes.find(front.topic_name);
+        if(it != m_topic_bytes.end())
+        {
+            it->second -= bytes;
+        }
+        m_queued_bytes.store(m_queued_bytes.load(memory_order_relaxed) - bytes, memory_order_relaxed);
+        if(out != nullptr)
+        {
+            *out = std::move(front);
+        }
+        m_msg_queue.pop();
+        if(m_msg_queue.empty())
+        {
+            m_trim_watermark = 0;
+        }
+        MemoryBudget::GetInstance().Release(bytes);
+    }
+    
+    void MQSparkAbstract::clearLocked()
+    {
+        while(!m_msg_queue.empty())
+        {
+            popFrontLocked(nullptr);
+        }
+    }
+    
+    bool MQSparkAbstract::shedOldest()
+    {
+        lock_guard<mutex> lock(m_msg_mutex);
+        if(m_msg_queue.empty())
+        {
+            return false;
+        }
+        popFrontLocked(nullptr);
+        m_shed_count.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    
     void MQSparkAbstract::messageProcessLoop()
     {
+        bool delete_self = false;
         while(true)
         {
             Message msg;
+            bool has_msg = false;
             {
                 unique_lock<mutex> lock(m_msg_mutex);
                 m_msg_cv.wait(lock, [this](){ 
@@ -55,18 +181,27 @@ namespace MQ
                 
                 if(m_stop_flag && m_msg_queue.empty())
                 {
+                    // 解锁后实例可能立即被其他线程回收，此后只能访问局部变量
+                    m_worker_running = false;
+                    delete_self = m_delete_pending;
                     break;
                 }
                 
+                // 跳过已过期的消息，未设置 TTL 的消息不读取时钟
+                if(!m_msg_queue.empty() && m_msg_queue.front().expire_at != chrono::steady_clock::time_point())
+                {
+                    trimExpired(chrono::steady_clock::now());
+                }
+                
                 if(!m_msg_queue.empty())
                 {
-                    msg = std::move(m_msg_queue.front());
-                    m_msg_queue.pop();
+                    popFrontLocked(&msg);
+                    has_msg = m_handle_ != nullptr;
                 }
             }
             
             // 处理消息
-            if(m_handle_ != nullptr)
+            if(has_msg)
             {
                 try
                 {
@@ -79,5 +214,113 @@ namespace MQ
                 }
             }
         }
+        if(delete_self)
+        {
+            delete this;
+        }
+    }
+    
+    void MQSparkAbstract::trimExpired(chrono::steady_clock::time_point now)
+    {
+        // 调用时已持有 m_msg_mutex，只清理队首连续过期的消息
+        uint64_t expired = 0;
+        while(!m_msg_queue.empty() && m_msg_queue.front().IsExpired(now))
+        {
+            popFrontLocked(nullptr);
+            ++expired;
+        }
+        if(expired != 0)
+        {
+            m_expired_count.fetch_add(expired, memory_order_relaxed);
+        }
+    }
+    
+    void MQSparkAbstract::compactExpired(chrono::steady_clock::time_point now)
+    {
+        // 调用时已持有 m_msg_mutex，保留未过期消息的先后顺序，过期消息经 popFrontLocked 归还预算
+        uint64_t expired = 0;
+        queue<Message> kept;
+        while(!m_msg_queue.empty())
+        {
+            if(m_msg_queue.front().IsExpired(now))
+            {
+                popFrontLocked(nullptr);
+                ++expired;
+            }
+            else
+            {
+                kept.emplace(std::move(m_msg_queue.front()));
+                m_msg_queue.pop();
+            }
+        }
+        m_msg_queue.swap(kept);
+        m_trim_watermark = m_msg_queue.size() * 2;
+        if(expired != 0)
+        {
+            m_expired_count.fetch_add(expired, memory_order_relaxed);
+        }
+    }
+    
+    uint64_t MQSparkAbstract::GetExpiredCount() const
+    {
+        return m_expired_count.load(memory_order_relaxed);
+    }
+    
+    void MQSparkAbstract::SetExpireTrimThreshold(size_t threshold)
+    {
+        lock_guard<mutex> lock(m_msg_mutex);
+        m_trim_threshold = threshold;
+        m_trim_watermark = 0;
+    }
+    
+    void MQSparkAbstract::SetPriority(int priority)
+    {
+        m_priority.store(priority, memory_order_relaxed);
+    }
+    
+    int MQSparkAbstract::GetPriority() const
+    {
+        return m_priority.load(memory_order_relaxed);
+    }
+    
+    size_t MQSparkAbstract::GetQueuedBytes() const
+    {
+        return m_queued_bytes.load(memory_order_relaxed);
+    }
+    
+    uint64_t MQSparkAbstract::GetShedCount() const
+    {
+        return m_shed_count.load(memory_order_relaxed);
+    }
+    
+    bool MQSparkAbstract::SetDispatchCpus(const vector<int>& cpus)
+    {
+        if(!Affinity::BindThread(m_worker_thread, cpus))
+        {
+            return false;
+        }
+        lock_guard<mutex> lock(m_msg_mutex);
+        m_dispatch_cpus = cpus;
+        return true;
+    }
+    
+    bool MQSparkAbstract::SetDispatchNumaNode(int node)
+    {
+        if(Affinity::NumaNodeCount() <= 1)
+        {
+            return false;
+        }
+        return SetDispatchCpus(Affinity::NumaNodeCpus(node));
+    }
+    
+    vector<int> MQSparkAbstract::GetDispatchCpus() const
+    {
+        lock_guard<mutex> lock(m_msg_mutex);
+        return m_dispatch_cpus;
+    }
+    
+    bool MQSparkAbstract::BindCurrentThread(const vector<int>& cpus)
+    {
+        return Affinity::BindCurrentThread(cpus);
     }
 }
@@ -0,0 +1,143 @@
+#include "payload.h"
+#include <fstream>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MQSPARK_HAS_MMAP 1
+#endif
+
+namespace MQ
+{
+    Payload::Payload()
+        : m_data(nullptr)
+        , m_size(0)
+    {}
+
+    Payload::Payload(shared_ptr<const char> buffer, const char* data, size_t size)
+        : m_buffer(std::move(buffer))
+        , m_data(data)
+        , m_size(size)
+    {}
+
+    Payload Payload::FromString(string data)
+    {
+        if(data.empty())
+        {
+            return Payload();
+        }
+        auto holder = make_shared<const string>(std::move(data));
+        const char* ptr = holder->data();
+        size_t size = holder->size();
+        // 别名构造：引用计数跟随 holder，指针指向字符串数据
+        return Payload(shared_ptr<const char>(holder, ptr), ptr, size);
+    }
+
+    Payload Payload::Copy(const void* data, size_t length)
+    {
+        if(data == nullptr || length == 0)
+        {
+            return Payload();
+        }
+        return FromString(string(static_cast<const char*>(data), length));
+    }
+
+    Payload Payload::Wrap(const void* data, size_t length, ReleaseCallback release)
+    {
+        if(data == nullptr)
+        {
+            if(release)
+            {
+                release();
+            }
+            return Payload();
+        }
+        const char* ptr = static_cast<const char*>(data);
+        shared_ptr<const char> buffer(ptr, [release](const char*)
+        {
+            if(release)
+            {
+                release();
+            }
+        });
+        return Payload(std::move(buffer), ptr, length);
+    }
+
+    Payload Payload::MapFile(const string& path, size_t offset, size_t length)
+    {
+#if MQSPARK_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            throw runtime_error("无法打开文件: " + path);
+        }
+        struct stat st;
+        if(::fstat(fd, &st) != 0 || offset > static_cast<size_t>(st.st_size))
+        {
+            ::close(fd);
+            throw runtime_error("文件偏移无效: " + path);
+        }
+        size_t file_size = static_cast<size_t>(st.st_size);
+        if(length == 0 || offset + length > file_size)
+        {
+            length = file_size - offset;
+        }
+        if(length == 0)
+        {
+            ::close(fd);
+            return Payload();
+        }
+        // mmap 偏移必须按页对齐，多映射的前缀在切片时跳过
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t aligned = offset - offset % page;
+        size_t map_len = length + (offset - aligned);
+        void* addr = ::mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(aligned));
+        ::close(fd);
+        if(addr == MAP_FAILED)
+        {
+            throw runtime_error("文件映射失败: " + path);
+        }
+        const char* base = static_cast<const char*>(addr);
+        shared_ptr<const char> buffer(base, [map_len](const char* p)
+        {
+            ::munmap(const_cast<char*>(p), map_len);
+        });
+        return Payload(std::move(buffer), base + (offset - aligned), length);
+#else
+        ifstream in(path, ios::binary);
+        if(!in)
+        {
+            throw runtime_error("无法打开文件: " + path);
+        }
+        in.seekg(0, ios::end);
+        size_t file_size = static_cast<size_t>(in.tellg());
+        if(offset > file_size)
+        {
+            throw runtime_error("文件偏移无效: " + path);
+        }
+        if(length == 0 || offset + length > file_size)
+        {
+            length = file_size - offset;
+        }
+        string data(length, '\0');
+        in.seekg(static_cast<streamoff>(offset));
+        in.read(&data[0], static_cast<streamsize>(length));
+        return FromString(std::move(data));
+#endif
+    }
+
+    Payload Payload::Slice(size_t offset, size_t length) const
+    {
+        if(offset > m_size || length > m_size - offset)
+        {
+            throw out_of_range("负载切片越界");
+        }
+        if(length == 0)
+        {
+            return Payload();
+        }
+        return Payload(m_buffer, m_data + offset, length);
+    }
+}
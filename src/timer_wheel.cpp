@@ -0,0 +1,212 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(ExpireHandle handle, chrono::milliseconds tick)
+    : m_current_tick(0)
+    , m_wake_tick(UINT64_MAX)
+    , m_next_id(1)
+    , m_start(Clock::now())
+    , m_tick(tick.count() > 0 ? tick : chrono::milliseconds(1))
+    , m_handle(std::move(handle))
+    , m_stop_flag(false)
+    , m_timer_thread(&TimerWheel::timerLoop, this)
+{}
+
+TimerWheel::~TimerWheel()
+{
+    Stop();
+}
+
+void TimerWheel::Stop()
+{
+    {
+        lock_guard<mutex> lock(m_mtx);
+        m_stop_flag = true;
+    }
+    m_cv.notify_one();
+    if(m_timer_thread.joinable())
+    {
+        m_timer_thread.join();
+    }
+}
+
+uint64_t TimerWheel::Schedule(Message msg, Clock::time_point when)
+{
+    uint64_t id;
+    bool wake;
+    {
+        lock_guard<mutex> lock(m_mtx);
+        id = m_next_id++;
+        if(m_index.empty())
+        {
+            // 时间轮为空时直接对齐到当前时间，避免定时线程空转补 tick
+            uint64_t now_tick = tickOf(Clock::now());
+            if(now_tick > m_current_tick)
+            {
+                m_current_tick = now_tick;
+            }
+        }
+        // 向上取整，保证不会早于 when 投递
+        uint64_t expire = tickOf(when + m_tick - chrono::nanoseconds(1));
+        if(expire <= m_current_tick)
+        {
+            expire = m_current_tick + 1;
+        }
+        // 先放入临时链表再挪到目标槽，保证迭代器在整个生命周期内有效
+        Slot staging;
+        staging.push_back(TimerEntry{id, expire, std::move(msg)});
+        place(staging, staging.begin());
+        // 早于定时线程当前的睡眠截止点才需要唤醒它重新计算
+        wake = expire < m_wake_tick;
+        if(wake)
+        {
+            m_wake_tick = expire;
+        }
+    }
+    if(wake)
+    {
+        m_cv.notify_one();
+    }
+    return id;
+}
+
+bool TimerWheel::Cancel(uint64_t timer_id)
+{
+    lock_guard<mutex> lock(m_mtx);
+    auto it = m_index.find(timer_id);
+    if(it == m_index.end())
+    {
+        return false;
+    }
+    it->second.slot->erase(it->second.iter);
+    m_index.erase(it);
+    return true;
+}
+
+size_t TimerWheel::PendingCount() const
+{
+    lock_guard<mutex> lock(m_mtx);
+    return m_index.size();
+}
+
+uint64_t TimerWheel::tickOf(Clock::time_point tp) const
+{
+    if(tp <= m_start)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(tp - m_start).count() / m_tick.count());
+}
+
+TimerWheel::Slot& TimerWheel::slotFor(uint64_t expire_tick)
+{
+    uint64_t delta = expire_tick - m_current_tick;
+    for(int level = 0; level < kLevels; ++level)
+    {
+        if(delta < (uint64_t(1) << (kSlotBits * (level + 1))))
+        {
+            return m_wheel[level][(expire_tick >> (kSlotBits * level)) & kSlotMask];
+        }
+    }
+    // 超出时间轮范围，挂在最高层最远的槽，级联时再重新定位
+    int top = kLevels - 1;
+    uint64_t horizon = m_current_tick + (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+    return m_wheel[top][(horizon >> (kSlotBits * top)) & kSlotMask];
+}
+
+void TimerWheel::place(Slot& from, Slot::iterator iter)
+{
+    Slot& target = slotFor(iter->expire_tick);
+    target.splice(target.end(), from, iter);
+    m_index[iter->id] = EntryPos{&target, iter};
+}
+
+void TimerWheel::cascade(int level)
+{
+    Slot& slot = m_wheel[level][(m_current_tick >> (kSlotBits * level)) & kSlotMask];
+    while(!slot.empty())
+    {
+        place(slot, slot.begin());
+    }
+}
+
+void TimerWheel::advance(uint64_t target_tick, vector<Message>& due)
+{
+    while(m_current_tick < target_tick)
+    {
+        ++m_current_tick;
+        // 低层转满一圈时，把上一层对应槽的定时器下放
+        for(int level = 1; level < kLevels; ++level)
+        {
+            if(((m_current_tick >> (kSlotBits * (level - 1))) & kSlotMask) != 0)
+            {
+                break;
+            }
+            cascade(level);
+        }
+        Slot& slot = m_wheel[0][m_current_tick & kSlotMask];
+        for(auto& entry : slot)
+        {
+            m_index.erase(entry.id);
+            due.emplace_back(std::move(entry.msg));
+        }
+        slot.clear();
+    }
+}
+
+uint64_t TimerWheel::nextWakeTick() const
+{
+    // 调用时已持有 m_mtx；级联只发生在第 0 层转满一圈时，之前只需找第一个非空槽
+    uint64_t boundary = (m_current_tick | kSlotMask) + 1;
+    for(uint64_t tick = m_current_tick + 1; tick < boundary; ++tick)
+    {
+        if(!m_wheel[0][tick & kSlotMask].empty())
+        {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+void TimerWheel::timerLoop()
+{
+    vector<Message> due;
+    while(true)
+    {
+        {
+            unique_lock<mutex> lock(m_mtx);
+            if(m_index.empty())
+            {
+                m_wake_tick = UINT64_MAX;
+                m_cv.wait(lock, [this](){ return m_stop_flag || !m_index.empty(); });
+                if(m_stop_flag)
+                {
+                    break;
+                }
+                continue;
+            }
+            uint64_t wake_tick = nextWakeTick();
+            m_wake_tick = wake_tick;
+            auto deadline = m_start + m_tick * static_cast<int64_t>(wake_tick);
+            m_cv.wait_until(lock, deadline, [this, wake_tick](){ return m_stop_flag || m_wake_tick < wake_tick; });
+            if(m_stop_flag)
+            {
+                break;
+            }
+            advance(tickOf(Clock::now()), due);
+        }
+
+        for(auto& msg : due)
+        {
+            try
+            {
+                m_handle(std::move(msg));
+            }
+            catch(const std::exception& e)
+            {
+                // 单条投递失败不影响其他到期消息
+                (void)e;
+            }
+        }
+        due.clear();
+    }
+}
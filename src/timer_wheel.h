@@ -0,0 +1,80 @@
+#ifndef C__MQSPARK_TIMER_WHEEL_H
+#define C__MQSPARK_TIMER_WHEEL_H
+#include "mqspark_abstract.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+using namespace MQ;
+
+/*
+ * @brief: 分层时间轮，保存延时/定时投递的消息
+ * @note 4 层 x 256 槽，tick 默认 1ms，单层覆盖 2^8 tick，整体覆盖 2^32 tick（1ms 下约 49 天），
+ * 更远的消息先挂在最高层，逐层级联时重新定位。插入与取消均为 O(1)，
+ * 全部定时器共用一个线程，到期后在锁外调用 ExpireHandle 投递。
+ * 定时线程只在下一个非空的第 0 层槽或级联边界醒来，空闲时最多每 256 tick 醒一次
+ * */
+class TimerWheel
+{
+public:
+    using ExpireHandle = function<void(Message&& msg)>;
+    using Clock = chrono::steady_clock;
+
+    explicit TimerWheel(ExpireHandle handle, chrono::milliseconds tick = chrono::milliseconds(1));
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    uint64_t Schedule(Message msg, Clock::time_point when);     ///< 返回定时器 id，已过期的时间点在下一个 tick 投递
+    bool Cancel(uint64_t timer_id);                             ///< 取消尚未投递的消息
+    size_t PendingCount() const;
+    void Stop();                                                ///< 停止定时线程并丢弃未到期的消息，可重复调用
+
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 8;
+    static const uint64_t kSlots = 1u << kSlotBits;
+    static const uint64_t kSlotMask = kSlots - 1;
+
+    struct TimerEntry
+    {
+        uint64_t id;
+        uint64_t expire_tick;
+        Message msg;
+    };
+    using Slot = list<TimerEntry>;
+    struct EntryPos
+    {
+        Slot* slot;
+        Slot::iterator iter;
+    };
+
+    uint64_t tickOf(Clock::time_point tp) const;
+    Slot& slotFor(uint64_t expire_tick);
+    void place(Slot& from, Slot::iterator iter);        // 将 from 中的节点挪到对应槽，不重新分配
+    void cascade(int level);
+    void advance(uint64_t target_tick, vector<Message>& due);
+    uint64_t nextWakeTick() const;                      // 下一个需要处理的 tick：非空的第 0 层槽或级联边界
+    void timerLoop();
+
+    Slot m_wheel[kLevels][kSlots];
+    unordered_map<uint64_t, EntryPos> m_index;
+    uint64_t m_current_tick;
+    uint64_t m_wake_tick;       ///< 定时线程本轮睡到的 tick，Schedule 插入更早的定时器时唤醒它
+    uint64_t m_next_id;
+    Clock::time_point m_start;
+    chrono::milliseconds m_tick;
+    ExpireHandle m_handle;
+
+    mutable mutex m_mtx;
+    condition_variable m_cv;
+    bool m_stop_flag;
+    thread m_timer_thread;      ///< 最后初始化
+};
+
+
+#endif//C__MQSPARK_TIMER_WHEEL_H
@@ -1,45 +1,140 @@
 #include "topic.h"
+#include "epoch_reclaimer.h"
 Topic::Topic(const string &topicName)
     : m_name(topicName)
+    , m_ttl_ms(0)
+    , m_sequence(0)
+    , m_snapshot(nullptr)
 {}
 
+Topic::~Topic()
+{
+    ClientList* old = m_snapshot.exchange(nullptr);
+    if(old != nullptr)
+    {
+        EpochReclaimer::GetInstance().Retire([old](){ delete old; });
+    }
+}
+
 string Topic::GetName() const
 {
     return m_name;
 }
 
-void Topic::Publish(const Message &msg)
+bool Topic::Publish(const Message &msg)
 {
-    // 发布消息时复制客户端列表，避免持有锁期间被修改
-    unordered_set<MQSparkShPtr> clients_copy;
+    EpochReclaimer::Guard guard;
+    const ClientList* clients = m_snapshot.load(memory_order_acquire);
+    if(clients == nullptr || clients->empty())
     {
-        lock_guard<mutex> lock(mtx);
-        clients_copy = m_clents;
+        return false;
     }
     
-    for(const auto& client : clients_copy)
+    // 发布时刻写入序列号、发布时间与过期时间，只拷贝一次，最后一个订阅者直接接管
+    // 调用方持有分片锁，同一主题的序列号与投递顺序一致
+    Message stamped(msg);
+    stamped.headers.sequence = m_sequence.fetch_add(1, memory_order_relaxed) + 1;
+    auto now = chrono::system_clock::now();
+    stamped.headers.publish_time_us = chrono::duration_cast<chrono::microseconds>(now.time_since_epoch()).count();
+    uint32_t ttl = msg.ttl_ms != 0 ? msg.ttl_ms : m_ttl_ms.load(memory_order_relaxed);
+    if(ttl != 0)
     {
-        if(client)
+        stamped.expire_at = chrono::steady_clock::now() + chrono::milliseconds(ttl);
+    }
+    
+    bool found_dead = false;
+    size_t remaining = clients->size();
+    for(MQSparkAbstract* client : *clients)
+    {
+        --remaining;
+        if(!client->IsAlive())
+        {
+            found_dead = true;
+            continue;
+        }
+        if(remaining == 0)
+        {
+            client->HandleMessage(std::move(stamped));
+        }
+        else
         {
-            client->HandleMessage(msg);
+            client->HandleMessage(stamped);
         }
     }
+    return found_dead;
 }
 
-void Topic::AddMsgIter(const MQSparkShPtr& msg_iter)
+void Topic::AddMsgIter(MQSparkAbstract* msg_iter)
 {
     lock_guard<mutex> lock(mtx);
-    m_clents.emplace(msg_iter);
+    if(m_clents.emplace(msg_iter).second)
+    {
+        updateSnapshot();
+    }
 }
 
-void Topic::DelMsgIter(const MQSparkShPtr& msg_iter)
+void Topic::DelMsgIter(MQSparkAbstract* msg_iter)
 {
     lock_guard<mutex> lock(mtx);
-    m_clents.erase(msg_iter);
+    if(m_clents.erase(msg_iter) != 0)
+    {
+        updateSnapshot();
+    }
 }
 
-bool Topic::IsExistClent(const MQSparkShPtr& msg_iter)
+bool Topic::IsExistClent(MQSparkAbstract* msg_iter)
 {
     lock_guard<mutex> lock(mtx);
     return m_clents.find(msg_iter) != m_clents.end();
 }
+
+bool Topic::Empty()
+{
+    lock_guard<mutex> lock(mtx);
+    return m_clents.empty();
+}
+
+size_t Topic::ClientCount()
+{
+    lock_guard<mutex> lock(mtx);
+    return m_clents.size();
+}
+
+vector<MQSparkAbstract*> Topic::PruneDead()
+{
+    vector<MQSparkAbstract*> dead;
+    lock_guard<mutex> lock(mtx);
+    for(auto it = m_clents.begin(); it != m_clents.end();)
+    {
+        if(!(*it)->IsAlive())
+        {
+            dead.push_back(*it);
+            it = m_clents.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if(!dead.empty())
+    {
+        updateSnapshot();
+    }
+    return dead;
+}
+
+void Topic::updateSnapshot()
+{
+    // 调用时已持有 mtx，旧快照可能仍在被发布线程遍历，交给纪元回收
+    ClientList* fresh = new ClientList(m_clents.begin(), m_clents.end());
+    ClientList* old = m_snapshot.exchange(fresh, memory_order_acq_rel);
+    if(old != nullptr)
+    {
+        EpochReclaimer::GetInstance().Retire([old](){ delete old; });
+    }
+}
+
+void Topic::SetTTL(uint32_t ttl_ms)
+{
+    m_ttl_ms.store(ttl_ms, memory_order_relaxed);
+}
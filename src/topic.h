@@ -3,25 +3,40 @@
 #include <memory>
 #include "message_interface.h"
 #include <unordered_set>
+#include <vector>
 #include <mutex>
+#include <atomic>
 using namespace std;
 using namespace MQ;
 
 /*
  * @brief: 主题
+ * @note 只保存订阅者的裸指针，不持有所有权。发布路径在 EpochReclaimer::Guard 内读取写时复制的
+ * 订阅者快照，无锁、无引用计数；已失效的订阅者由发布路径发现后交给 TopicManager 摘除
  * */
 class Topic
 {
     public:
         explicit Topic(const string& topicName);
+        ~Topic();
         string GetName() const;
-        void AddMsgIter(const MQSparkShPtr& msg_iter);
-        void Publish(const Message& msg);
-        void DelMsgIter(const MQSparkShPtr& msg_iter);
-        bool IsExistClent(const MQSparkShPtr& msg_iter);
+        void AddMsgIter(MQSparkAbstract* msg_iter);
+        bool Publish(const Message& msg);               ///< 返回是否遇到已失效的订阅者
+        void DelMsgIter(MQSparkAbstract* msg_iter);
+        bool IsExistClent(MQSparkAbstract* msg_iter);
+        bool Empty();
+        size_t ClientCount();
+        vector<MQSparkAbstract*> PruneDead();           ///< 摘除已失效的订阅者并返回
+        void SetTTL(uint32_t ttl_ms);
     private:
+        using ClientList = vector<MQSparkAbstract*>;
+        void updateSnapshot();
+
         string m_name;
-        unordered_set<MQSparkShPtr> m_clents;
+        atomic<uint32_t> m_ttl_ms;    ///< 主题默认消息存活时间，0 表示永不过期
+        atomic<uint64_t> m_sequence;  ///< 最近一次发布的序列号，主题重建后从 1 重新开始
+        unordered_set<MQSparkAbstract*> m_clents;
+        atomic<ClientList*> m_snapshot;     ///< m_clents 的只读副本，供发布路径无锁读取
         mutex mtx;
 };
 
@@ -1,7 +1,13 @@
 #include "topic_manager.h"
 #include "topic.h"
+#include "epoch_reclaimer.h"
+#include "memory_budget.h"
 #include <iostream>
-bool TopicManager::AddTopic(const string& topic_name, const MQSparkShPtr& msg_iter)
+TopicManager::TopicManager(ReleaseHandle released)
+    : released_handle(std::move(released))
+{}
+
+bool TopicManager::AddTopic(const string& topic_name, MQSparkAbstract* msg_iter)
 {
     lock_guard<mutex> lock(mtx);
     auto it = topics.find(topic_name);
@@ -13,44 +19,251 @@ bool TopicManager::AddTopic(const string& topic_name, const MQSparkShPtr& msg_it
             return false;
         }
         it->second->AddMsgIter(msg_iter);
+        client_topics[msg_iter].insert(topic_name);
         return true;
     }
     cout << "添加主题成功: " << topic_name << endl;
     // 创建unique_ptr并插入到map中
     auto topic_ptr = make_unique<Topic>(topic_name);
+    auto ttl_it = topic_ttls.find(topic_name);
+    if(ttl_it != topic_ttls.end())
+    {
+        topic_ptr->SetTTL(ttl_it->second);
+    }
     topic_ptr->AddMsgIter(msg_iter);
     topics.emplace(topic_name, std::move(topic_ptr));
+    client_topics[msg_iter].insert(topic_name);
     return true;
 }
 
-bool TopicManager::RemoveTopic(const string& topic_name, const MQSparkShPtr& msg_iter)
+bool TopicManager::RemoveTopic(const string& topic_name, MQSparkAbstract* msg_iter)
 {
     lock_guard<mutex> lock(mtx);
     auto it = topics.find(topic_name);
     if(it != topics.end())
     {
         it->second->DelMsgIter(msg_iter);
+        eraseIfEmpty(it);
+        auto client_it = client_topics.find(msg_iter);
+        if(client_it != client_topics.end())
+        {
+            client_it->second.erase(topic_name);
+            if(client_it->second.empty())
+            {
+                client_topics.erase(client_it);
+            }
+        }
         return true;
     }
     return false;
 }
-bool TopicManager::PublishMsg(const Message &msg)
+bool TopicManager::PublishMsg(const Message &msg, bool check_dedup)
 {
+    // Backpressure 可能需要等待，在取分片锁之前为整个扇出一次性预留，锁内入队只做不等待的申请
+    MemoryBudget::FanoutReservation reservation;
+    if(MemoryBudget::FanoutReservation::Needed())
+    {
+        reservation.Reserve(MemoryBudget::MessageBytes(msg) * subscriberCount(msg.topic_name));
+    }
     lock_guard<mutex> lock(mtx);
+    if(check_dedup && isDuplicateLocked(msg))
+    {
+        return false;
+    }
     auto it = topics.find(msg.topic_name);
     if(it != topics.end())
     {
-        it->second->Publish(msg);
+        if(it->second->Publish(msg))
+        {
+            pruneDead(it);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TopicManager::CheckDuplicate(const Message &msg)
+{
+    lock_guard<mutex> lock(mtx);
+    return isDuplicateLocked(msg);
+}
+
+bool TopicManager::isDuplicateLocked(const Message &msg)
+{
+    // 调用时已持有 mtx
+    if(dedup && msg.headers.producer_id != 0 && dedup->IsDuplicate(msg.headers.producer_id, msg.headers.producer_seq))
+    {
+        ++duplicate_count;
         return true;
     }
     return false;
 }
 
-void TopicManager::DelMsgPtr(const MQSparkShPtr &msg_iter)
+size_t TopicManager::subscriberCount(const string& topic_name)
+{
+    lock_guard<mutex> lock(mtx);
+    auto it = topics.find(topic_name);
+    return it == topics.end() ? 0 : it->second->ClientCount();
+}
+
+void TopicManager::DelMsgPtr(MQSparkAbstract* msg_iter)
+{
+    lock_guard<mutex> lock(mtx);
+    // 只遍历该订阅者自己的主题，开销与其订阅数成正比
+    auto client_it = client_topics.find(msg_iter);
+    if(client_it == client_topics.end())
+    {
+        return;
+    }
+    for(const auto& topic_name : client_it->second)
+    {
+        auto it = topics.find(topic_name);
+        if(it != topics.end())
+        {
+            it->second->DelMsgIter(msg_iter);
+            eraseIfEmpty(it);
+        }
+    }
+    client_topics.erase(client_it);
+}
+
+void TopicManager::RetireClient(MQSparkAbstract* msg_iter)
+{
+    lock_guard<mutex> lock(mtx);
+    auto client_it = client_topics.find(msg_iter);
+    if(client_it == client_topics.end())
+    {
+        reclaim(msg_iter);
+        return;
+    }
+    // 由发布路径发现后再摘除；长期没有消息的主题上积压过多时统一清理，保证内存有界
+    dead_clients.insert(msg_iter);
+    if(dead_clients.size() < kMaxDeadClients)
+    {
+        return;
+    }
+    for(MQSparkAbstract* dead : dead_clients)
+    {
+        auto dead_it = client_topics.find(dead);
+        if(dead_it != client_topics.end())
+        {
+            for(const auto& topic_name : dead_it->second)
+            {
+                auto it = topics.find(topic_name);
+                if(it != topics.end())
+                {
+                    it->second->DelMsgIter(dead);
+                    eraseIfEmpty(it);
+                }
+            }
+            client_topics.erase(dead_it);
+        }
+        reclaim(dead);
+    }
+    dead_clients.clear();
+}
+
+vector<MQSparkAbstract*> TopicManager::TakeDeadClients()
 {
     lock_guard<mutex> lock(mtx);
-    for(auto& topic : topics)
+    vector<MQSparkAbstract*> taken(dead_clients.begin(), dead_clients.end());
+    for(MQSparkAbstract* dead : taken)
+    {
+        auto dead_it = client_topics.find(dead);
+        if(dead_it == client_topics.end())
+        {
+            continue;
+        }
+        for(const auto& topic_name : dead_it->second)
+        {
+            auto it = topics.find(topic_name);
+            if(it != topics.end())
+            {
+                it->second->DelMsgIter(dead);
+                eraseIfEmpty(it);
+            }
+        }
+        client_topics.erase(dead_it);
+    }
+    dead_clients.clear();
+    return taken;
+}
+
+void TopicManager::pruneDead(unordered_map<string, unique_ptr<Topic>>::iterator it)
+{
+    // 调用时已持有 mtx
+    const string topic_name = it->first;
+    for(MQSparkAbstract* dead : it->second->PruneDead())
+    {
+        auto client_it = client_topics.find(dead);
+        if(client_it != client_topics.end())
+        {
+            client_it->second.erase(topic_name);
+            if(!client_it->second.empty())
+            {
+                continue;
+            }
+            client_topics.erase(client_it);
+        }
+        // 已从所有主题摘除，宽限期后释放
+        if(dead_clients.erase(dead) != 0)
+        {
+            reclaim(dead);
+        }
+    }
+    eraseIfEmpty(it);
+}
+
+void TopicManager::reclaim(MQSparkAbstract* msg_iter)
+{
+    if(released_handle)
     {
-        topic.second->DelMsgIter(msg_iter);
+        released_handle(msg_iter);
+        return;
     }
+    EpochReclaimer::GetInstance().Retire([msg_iter](){ msg_iter->DeleteWhenIdle(); });
+}
+
+void TopicManager::eraseIfEmpty(unordered_map<string, unique_ptr<Topic>>::iterator it)
+{
+    // 调用时已持有 mtx，没有订阅者的主题直接回收，主题 TTL 配置保存在 topic_ttls 中不受影响
+    if(it->second->Empty())
+    {
+        topics.erase(it);
+    }
+}
+
+void TopicManager::SetTopicTTL(const string& topic_name, uint32_t ttl_ms)
+{
+    lock_guard<mutex> lock(mtx);
+    if(ttl_ms == 0)
+    {
+        topic_ttls.erase(topic_name);
+    }
+    else
+    {
+        topic_ttls[topic_name] = ttl_ms;
+    }
+    auto it = topics.find(topic_name);
+    if(it != topics.end())
+    {
+        it->second->SetTTL(ttl_ms);
+    }
+}
+
+void TopicManager::EnableDedup(size_t producer_slots)
+{
+    lock_guard<mutex> lock(mtx);
+    if(producer_slots == 0)
+    {
+        dedup.reset();
+        return;
+    }
+    dedup.reset(new DedupWindow(producer_slots));
+}
+
+uint64_t TopicManager::DuplicateCount()
+{
+    lock_guard<mutex> lock(mtx);
+    return duplicate_count;
 }
@@ -4,22 +4,65 @@
 #include <memory>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
-#include "public_macro.h"
+#include <functional>
 #include "topic.h"
+#include "dedup_window.h"
 using namespace std;
 using namespace MQ;
 
+/*
+ * @brief: 主题注册表（代理的一个分片）
+ * */
 class TopicManager
 {
-    SINGLETON(TopicManager)
 public:
-    bool AddTopic(const string& topic_name, const MQSparkShPtr& msg_iter);
-    bool RemoveTopic(const string& topic_name, const MQSparkShPtr& msg_iter);
-    bool PublishMsg(const Message& msg);
-    void DelMsgPtr(const MQSparkShPtr& msg_iter);
+    using ReleaseHandle = function<void(MQSparkAbstract* msg_iter)>;
+    
+    /**
+     * @param released 失效订阅者从本分片全部摘除后回调，为空时直接交给纪元回收
+     */
+    explicit TopicManager(ReleaseHandle released = nullptr);
+    TopicManager(const TopicManager&) = delete;
+    TopicManager& operator=(const TopicManager&) = delete;
+    
+
+    bool AddTopic(const string& topic_name, MQSparkAbstract* msg_iter);
+    bool RemoveTopic(const string& topic_name, MQSparkAbstract* msg_iter);
+    /**
+     * @param check_dedup 为 false 时跳过去重，用于提交时已经检查过的定时消息
+     * @return 主题不存在或判定为重复时返回 false
+     */
+    bool PublishMsg(const Message& msg, bool check_dedup = true);
+    bool CheckDuplicate(const Message& msg);        ///< 去重检查并记录序号，重复时计数并返回 true
+    void DelMsgPtr(MQSparkAbstract* msg_iter);
+    void RetireClient(MQSparkAbstract* msg_iter);   ///< 订阅者已失效，接管其所有权，摘除后延迟释放
+    vector<MQSparkAbstract*> TakeDeadClients();     ///< 摘除尚未回收的失效订阅者并交出所有权，用于代理析构
+    void SetTopicTTL(const string& topic_name, uint32_t ttl_ms);
+    
+    /**
+     * @brief 开启按 (producer_id, producer_seq) 去重
+     * @param producer_slots 同时跟踪的生产者数量，0 表示关闭；重新设置会清空已记录的序号
+     * @note 只对 headers.producer_id 非 0 的消息生效
+     */
+    void EnableDedup(size_t producer_slots);
+    uint64_t DuplicateCount();
 private:
     unordered_map<string, unique_ptr<Topic>> topics;
+    unordered_map<string, uint32_t> topic_ttls;     ///< 主题默认 TTL，主题创建前设置也生效
+    unordered_map<MQSparkAbstract*, unordered_set<string>> client_topics;  ///< 反向索引：订阅者 -> 已订阅主题
+    unordered_set<MQSparkAbstract*> dead_clients;   ///< 已失效但仍挂在主题上的订阅者
+    static const size_t kMaxDeadClients = 256;
+    
+    void eraseIfEmpty(unordered_map<string, unique_ptr<Topic>>::iterator it);
+    void pruneDead(unordered_map<string, unique_ptr<Topic>>::iterator it);
+    void reclaim(MQSparkAbstract* msg_iter);
+    size_t subscriberCount(const string& topic_name);
+    bool isDuplicateLocked(const Message& msg);
+    unique_ptr<DedupWindow> dedup;                  ///< 为空表示未开启去重
+    uint64_t duplicate_count = 0;
+    ReleaseHandle released_handle;
     mutex mtx;
 };
 
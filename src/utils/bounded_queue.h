@@ -0,0 +1,117 @@
+#ifndef C__MQSPARK_BOUNDED_QUEUE_H
+#define C__MQSPARK_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+ * @brief: 有界无锁队列（Vyukov MPMC 算法）
+ * @note 容量向上取整为 2 的幂；每个槽位用序号区分可写/可读，入队出队各一次 CAS，无锁、无内存分配
+ * */
+namespace MQ
+{
+    template<typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while(size < capacity)
+            {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_cells.reset(new Cell[size]);
+            for(size_t i = 0; i < size; ++i)
+            {
+                m_cells[i].seq.store(i, std::memory_order_relaxed);
+            }
+            m_enqueue_pos.store(0, std::memory_order_relaxed);
+            m_dequeue_pos.store(0, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // 队列满时返回 false，value 保持不变
+        bool TryPush(T& value)
+        {
+            size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            Cell* cell;
+            while(true)
+            {
+                cell = &m_cells[pos & m_mask];
+                size_t seq = cell->seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if(diff == 0)
+                {
+                    if(m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(value);
+            cell->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(T& value)
+        {
+            size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            Cell* cell;
+            while(true)
+            {
+                cell = &m_cells[pos & m_mask];
+                size_t seq = cell->seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if(diff == 0)
+                {
+                    if(m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->data);
+            cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t Capacity() const { return m_mask + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> seq;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask;
+        alignas(64) std::atomic<size_t> m_enqueue_pos;
+        alignas(64) std::atomic<size_t> m_dequeue_pos;
+    };
+}
+
+#endif//C__MQSPARK_BOUNDED_QUEUE_H
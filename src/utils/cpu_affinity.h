@@ -0,0 +1,148 @@
+#ifndef C__MQSPARK_CPU_AFFINITY_H
+#define C__MQSPARK_CPU_AFFINITY_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * @brief: CPU 亲和性与 NUMA 拓扑工具
+ * @note 仅在 Linux 下生效，其他平台所有接口均为空操作并返回 false / 空结果
+ * */
+namespace MQ
+{
+namespace Affinity
+{
+    // 解析 "0-3,8,10-11" 形式的 cpulist
+    inline std::vector<int> ParseCpuList(const std::string& list)
+    {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while(std::getline(ss, range, ','))
+        {
+            if(range.empty() || range == "\n")
+            {
+                continue;
+            }
+            auto dash = range.find('-');
+            try
+            {
+                if(dash == std::string::npos)
+                {
+                    cpus.push_back(std::stoi(range));
+                    continue;
+                }
+                int first = std::stoi(range.substr(0, dash));
+                int last = std::stoi(range.substr(dash + 1));
+                for(int cpu = first; cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            catch(const std::exception&)
+            {
+                // 格式异常的片段直接忽略
+            }
+        }
+        return cpus;
+    }
+
+    // 当前机器在线的 NUMA 节点编号，无法获取时视为单节点 {0}
+    inline std::vector<int> OnlineNumaNodes()
+    {
+#if defined(__linux__)
+        std::ifstream in("/sys/devices/system/node/online");
+        std::string list;
+        if(in && std::getline(in, list))
+        {
+            auto nodes = ParseCpuList(list);
+            if(!nodes.empty())
+            {
+                return nodes;
+            }
+        }
+#endif
+        return {0};
+    }
+
+    inline int NumaNodeCount()
+    {
+        return static_cast<int>(OnlineNumaNodes().size());
+    }
+
+    // 指定 NUMA 节点上的 CPU 列表
+    inline std::vector<int> NumaNodeCpus(int node)
+    {
+#if defined(__linux__)
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if(in && std::getline(in, list))
+        {
+            return ParseCpuList(list);
+        }
+#endif
+        (void)node;
+        return {};
+    }
+
+#if defined(__linux__)
+    inline bool bindNative(pthread_t handle, const std::vector<int>& cpus)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(int cpu : cpus)
+        {
+            if(cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &set);
+            }
+        }
+        if(CPU_COUNT(&set) == 0)
+        {
+            return false;
+        }
+        return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+    }
+#endif
+
+    // 将线程绑定到指定 CPU 集合，cpus 为空或平台不支持时返回 false
+    inline bool BindThread(std::thread& th, const std::vector<int>& cpus)
+    {
+#if defined(__linux__)
+        if(cpus.empty() || !th.joinable())
+        {
+            return false;
+        }
+        return bindNative(th.native_handle(), cpus);
+#else
+        (void)th;
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    // 将调用线程绑定到指定 CPU 集合
+    inline bool BindCurrentThread(const std::vector<int>& cpus)
+    {
+#if defined(__linux__)
+        if(cpus.empty())
+        {
+            return false;
+        }
+        return bindNative(pthread_self(), cpus);
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+}
+}
+
+#endif//C__MQSPARK_CPU_AFFINITY_H
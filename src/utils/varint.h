@@ -0,0 +1,66 @@
+#ifndef C__MQSPARK_VARINT_H
+#define C__MQSPARK_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * @brief: LEB128 变长整数编解码
+ * */
+namespace MQ
+{
+namespace Varint
+{
+    static const size_t kMaxBytes = 10;
+
+    // 编码到 out，返回写入字节数，out 至少 kMaxBytes
+    inline size_t Encode(uint64_t value, char* out)
+    {
+        size_t n = 0;
+        while(value >= 0x80)
+        {
+            out[n++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out[n++] = static_cast<char>(value);
+        return n;
+    }
+
+    // 从 [pos, end) 解码，成功时前移 pos，数据不完整返回 false
+    inline bool Decode(const char*& pos, const char* end, uint64_t& value)
+    {
+        value = 0;
+        int shift = 0;
+        const char* p = pos;
+        while(p < end && shift < 64)
+        {
+            uint8_t byte = static_cast<uint8_t>(*p++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+            {
+                pos = p;
+                return true;
+            }
+            shift += 7;
+        }
+        return false;
+    }
+
+    // 解码长度前缀的字节串，成功时 data/size 指向原始内存
+    inline bool DecodeBytes(const char*& pos, const char* end, const char*& data, size_t& size)
+    {
+        uint64_t len = 0;
+        const char* p = pos;
+        if(!Decode(p, end, len) || len > static_cast<uint64_t>(end - p))
+        {
+            return false;
+        }
+        data = p;
+        size = static_cast<size_t>(len);
+        pos = p + len;
+        return true;
+    }
+}
+}
+
+#endif//C__MQSPARK_VARINT_H
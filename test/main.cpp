@@ -1,7 +1,11 @@
 #include "producer.h"
 #include "consumer.h"
+#include "policy_broker.h"
+#include "memory_budget.h"
+#include "epoch_reclaimer.h"
 #include <thread>
 #include <iostream>
+#include <atomic>
 
 int Consumer::count = 0;
 int Producer::count = 0;
@@ -35,6 +39,79 @@ void consumerThread() {
     c_.UnsubTopic("d_test");
 }
 
+// 订阅者频繁创建/销毁的压力测试：不调用 UnsubTopicAll，存活的订阅者数量应保持有界，
+// 回收完成后订阅者、待回收项和队列内存都应归零
+static atomic<int> live_subscribers(0);
+static const int kChurnPeakBound = 512;     // 每个分片最多积压 256 个失效订阅者，再加上等待纪元回收的部分
+class ChurnSubscriber : public MessageInterface
+{
+public:
+    ChurnSubscriber() { live_subscribers++; }
+    ~ChurnSubscriber() override { live_subscribers--; }
+};
+
+bool churnThread()
+{
+    atomic<bool> stop(false);
+    MQSparkShPtr publisher = MessageInterface::Create<MessageInterface>();
+    std::thread pub([&]() {
+        while(!stop)
+        {
+            publisher->PublishMessage(Message("churn", "churn_test"));
+        }
+    });
+    int peak = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        MQSparkShPtr sub = MessageInterface::Create<ChurnSubscriber>();
+        sub->RegMsgHandleCallback([](const Message&) {});
+        sub->SubTopic("churn_test");
+        peak = max(peak, live_subscribers.load());
+    }
+    stop = true;
+    pub.join();
+
+    // 再发布一次，让发布路径摘除剩余的失效订阅者，然后等回收线程处理完
+    publisher->PublishMessage(Message("churn", "churn_test"));
+    size_t pending = 0;
+    size_t queued_bytes = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pending = EpochReclaimer::GetInstance().PendingCount();
+        queued_bytes = MemoryBudget::GetInstance().QueuedBytes();
+        if (live_subscribers == 0 && pending == 0 && queued_bytes == 0)
+        {
+            break;
+        }
+    }
+    cout << "churn: peak live subscribers = " << peak << ", now = " << live_subscribers
+         << ", pending reclaim = " << pending << ", queued bytes = " << queued_bytes << endl;
+    bool ok = peak <= kChurnPeakBound && live_subscribers == 0 && pending == 0 && queued_bytes == 0;
+    if (!ok)
+    {
+        cerr << "churn: 回收后仍有残留，或峰值超过 " << kChurnPeakBound << endl;
+    }
+    return ok;
+}
+
+// 编译期策略组合的代理：发布只入队，回调在消费者调用 Poll() 时执行
+void policyBrokerDemo()
+{
+    int received = 0;
+    auto sub = MQ::MakeSubscriber<MQ::Policy::PolledDelivery, MQ::Policy::RingQueue, MQ::Policy::NullLock>(
+        [&received](const MQ::Message&) { ++received; });
+    MQ::BasicBroker<decltype(sub)::element_type, MQ::Policy::NullLock> broker;
+    broker.Subscribe("policy", *sub);
+    for (int i = 0; i < 100; ++i)
+    {
+        broker.Publish(MQ::Message(to_string(i), "policy"));
+    }
+    sub->Poll();
+    broker.UnsubscribeAll(*sub);
+    cout << "policy broker: received = " << received << endl;
+}
+
 int main()
 {
     cout << " ================ start ================ " << endl;
@@ -45,6 +122,8 @@ int main()
 
     producer.join();
     consumer.join();
+    bool churn_ok = churnThread();
+    policyBrokerDemo();
     cout << " ================ end ================ " << endl;
-    return 0;
+    return churn_ok ? 0 : 1;
 }